@@ -1,36 +1,28 @@
 /*
  * Button.c
  *
+ * All inputs are debounced at once with a 2-bit vertical counter: bit n
+ * of ct0/ct1 is the counter of input n, so one pass of byte-wide logic
+ * steps all eight counters.
+ *
  * Created: 24-Nov-18 11:51:44 AM
  *  Author: Vlad
  */ 
 
 #include <avr/io.h>
+#include <util/atomic.h>
 
 #include "Button_debounce.h"
+#include "timer2.h"
 
-struct BUTTON_CONFIGURATION
-{
-	volatile uint8_t *io;
-	const uint8_t mask;
-	volatile uint8_t debounce_counter;
-	const uint8_t debounce_threshold;
-	volatile bool is_pressed;
-	volatile uint8_t last_io_state;
-	volatile bool actionTaken;
-	const char *name;
-};
+#define BUTTON_PINC_MASK	(1 << PINC0 | 1 << PINC1 | 1 << PINC2 | 1 << PINC3 | 1 << PINC4 | 1 << PINC5)
 
-struct BUTTON_CONFIGURATION inputs[] =
-{
-	{&PINC, 1 << PINC0, 0, 0x0A, true, 1 << PINC0, true, "BTN1"},
-	{&PINC, 1 << PINC1, 0, 0x0A, true, 1 << PINC1, true, "BTN2"},
-	{&PINC, 1 << PINC2, 0, 0x0A, true, 1 << PINC2, true, "BTN3"},
-	{&PINC, 1 << PINC3, 0, 0x0A, true, 1 << PINC3, true, "BTN4"},
-	{&PINC, 1 << PINC4, 0, 0x0A, true, 1 << PINC4, true, "BTN5"},
-	{&PINC, 1 << PINC5, 0, 0x0A, true, 1 << PINC5, true, "BTN6"},
-	{&PINB, 1 << PINB0, 0, 0x0A, true, 1 << PINB0, true, "BTN_ENCODER"},
-};
+static volatile uint8_t _state;		// debounced, 1 = pressed
+static volatile uint8_t _pressed;
+static volatile uint8_t _released;
+static uint8_t _ct0 = 0xFF;
+static uint8_t _ct1 = 0xFF;
+static uint16_t _edgeTime[BUTTON_COUNT];
 
 void button_init(void)
 {
@@ -41,43 +33,76 @@ void button_init(void)
 	PORTB |= (1 << PORTB0);
 }
 
-inline static void button_process( struct BUTTON_CONFIGURATION *input)
+// BTN1..BTN6 on PC0..PC5, the encoder switch on PB0, all active low.
+static inline uint8_t button_read_pins(void)
+{
+	return (uint8_t)~((PINC & BUTTON_PINC_MASK) | ((PINB & (1 << PINB0)) << Button_ENC));
+}
+
+void button_routine(void)
 {
-	uint8_t current_io_state = *input->io & input->mask;
+	uint8_t state = _state;
+	uint8_t changed = state ^ button_read_pins();
 	
-	if(current_io_state != input->last_io_state)
-	{
-		input->debounce_counter = 0;
-		input->actionTaken = false;
-	}
-	else if(input->actionTaken == false)
+	// Count inputs that differ from their debounced state, reset the rest.
+	_ct0 = ~(_ct0 & changed);
+	_ct1 = _ct0 ^ (_ct1 & changed);
+	changed &= _ct0 & _ct1;		// counters that rolled over
+	
+	state ^= changed;
+	_state = state;
+	_pressed |= state & changed;
+	_released |= ~state & changed;
+	
+	if(changed)
 	{
-		if(input->debounce_counter >= input->debounce_threshold)
+		uint16_t now = timer2_get_samples();
+		for(uint8_t btn = 0; btn < BUTTON_COUNT; btn++, changed >>= 1)
 		{
-			input->is_pressed = input->is_pressed ? false : true;
-			input->actionTaken = true;
-		}
-		else
-		{
-			input->debounce_counter++;
+			if(changed & 1)
+			{
+				_edgeTime[btn] = now;
+			}
 		}
 	}
-	
-	input->last_io_state = current_io_state;
 }
 
-void button_routine(void)
+bool button_is_pressed(BUTTON btn)
 {
+	return (_state & (1 << btn)) != 0;
+}
 
-	for (uint8_t i = 0; i < sizeof(inputs)/sizeof(inputs[0]); i++)
+uint8_t button_take_pressed(void)
+{
+	uint8_t mask;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
 	{
-		struct BUTTON_CONFIGURATION *input = &inputs[i];
-		button_process(input);
+		mask = _pressed;
+		_pressed = 0;
 	}
+	return mask;
+}
 
+uint16_t button_get_edge_time(BUTTON btn)
+{
+	uint16_t time;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		time = _edgeTime[btn];
+	}
+	return time;
 }
 
-bool button_is_pressed(BUTTON btn)
+uint8_t button_take_released(void)
 {
-	return inputs[(uint8_t)btn].is_pressed == true ? false : true;
+	uint8_t mask;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		mask = _released;
+		_released = 0;
+	}
+	return mask;
 }
@@ -10,7 +10,20 @@
 #define BUTTON_DEBOUNCE_H_
 
 #include "globals.h"
+#include "timer2.h"
 
+// Inputs are scanned only from the timer2 tick. A 2-bit vertical counter
+// takes a level change after 4 equal samples, so the scan runs every
+// BUTTON_DEBOUNCE_MS / 4 and BUTTON_DEBOUNCE_MS must be a multiple of
+// 4 * TIMER2_TICK_MS.
+#define BUTTON_DEBOUNCE_MS		4
+#define BUTTON_SCAN_MS			(BUTTON_DEBOUNCE_MS / 4)
+
+#if BUTTON_DEBOUNCE_MS == 0 || (BUTTON_DEBOUNCE_MS % (4 * TIMER2_TICK_MS)) != 0
+#error "BUTTON_DEBOUNCE_MS must be a non-zero multiple of 4 * TIMER2_TICK_MS"
+#endif
+
+// Values are bit positions in the masks below.
 typedef enum Button {
 	Button_1	= 0, 
 	Button_2	= 1, 
@@ -21,12 +34,23 @@ typedef enum Button {
 	Button_ENC	= 6
 } BUTTON;
 
+#define BUTTON_COUNT	7
+
 void button_init(void);
 
+// Called from the timer2 interrupt every BUTTON_SCAN_MS, nowhere else.
 void button_routine(void);
 
 bool button_is_pressed(BUTTON btn);
 
+// Return and clear the buttons debounced to pressed / released since the
+// last call, as (1 << BUTTON) masks.
+uint8_t button_take_pressed(void);
+uint8_t button_take_released(void);
+
+// timer2_get_samples() of the scan that debounced the button's last edge.
+uint16_t button_get_edge_time(BUTTON btn);
+
 
 
 
@@ -1,6 +1,10 @@
 /*
  * usb_hid_consumer.h
  *
+ * Consumer page (0x0C) usages from the HID Usage Tables 1.12, section 15.
+ * Values above 0xFF, the AL launchers and AC commands among them, need
+ * KEYBOARD_CONSUMER_ACTION() in a keymap, see keyboard.h.
+ *
  * Created: 26-Nov-18 2:38:56 PM
  *  Author: Vlad
  */ 
@@ -9,24 +13,394 @@
 #ifndef USB_HID_CONSUMER_H_
 #define USB_HID_CONSUMER_H_
 
+#define HID_CONSUMER_NONE			0x00
+
+// Generic
+#define HID_CONSUMER_CONSUMER_CONTROL	0x01
+#define HID_CONSUMER_NUMERIC_KEY_PAD	0x02
+#define HID_CONSUMER_PROGRAMMABLE_BUTTONS	0x03
+#define HID_CONSUMER_MICROPHONE			0x04
+#define HID_CONSUMER_HEADPHONE			0x05
+#define HID_CONSUMER_GRAPHIC_EQUALIZER	0x06
+#define HID_CONSUMER_PLUS_10			0x20
+#define HID_CONSUMER_PLUS_100			0x21
+#define HID_CONSUMER_AM_PM				0x22
+
+// Power and menus
+#define HID_CONSUMER_POWER				0x30
+#define HID_CONSUMER_RESET				0x31
+#define HID_CONSUMER_SLEEP				0x32
+#define HID_CONSUMER_SLEEP_AFTER		0x33
+#define HID_CONSUMER_SLEEP_MODE			0x34
+#define HID_CONSUMER_ILLUMINATION		0x35
+#define HID_CONSUMER_FUNCTION_BUTTONS	0x36
+#define HID_CONSUMER_MENU				0x40
+#define HID_CONSUMER_MENU_PICK			0x41
+#define HID_CONSUMER_MENU_UP			0x42
+#define HID_CONSUMER_MENU_DOWN			0x43
+#define HID_CONSUMER_MENU_LEFT			0x44
+#define HID_CONSUMER_MENU_RIGHT			0x45
+#define HID_CONSUMER_MENU_ESCAPE		0x46
+#define HID_CONSUMER_MENU_VALUE_INC		0x47
+#define HID_CONSUMER_MENU_VALUE_DEC		0x48
+#define HID_CONSUMER_DATA_ON_SCREEN		0x60
+#define HID_CONSUMER_CLOSED_CAPTION		0x61
+#define HID_CONSUMER_CLOSED_CAPTION_SEL	0x62
+#define HID_CONSUMER_VCR_TV				0x63
+#define HID_CONSUMER_BROADCAST_MODE		0x64
+#define HID_CONSUMER_SNAPSHOT			0x65
+#define HID_CONSUMER_STILL				0x66
+#define HID_CONSUMER_BRIGHTNESS_UP		0x6F
+#define HID_CONSUMER_BRIGHTNESS_DOWN	0x70
+
+// Selection
+#define HID_CONSUMER_SELECTION			0x80
+#define HID_CONSUMER_ASSIGN_SEL			0x81
+#define HID_CONSUMER_MODE_STEP			0x82
+#define HID_CONSUMER_RECALL_LAST		0x83
+#define HID_CONSUMER_ENTER_CHANNEL		0x84
+#define HID_CONSUMER_ORDER_MOVIE		0x85
+#define HID_CONSUMER_CHANNEL			0x86
+#define HID_CONSUMER_MEDIA_SELECTION	0x87
+#define HID_CONSUMER_MEDIA_SEL_COMPUTER	0x88
+#define HID_CONSUMER_MEDIA_SEL_TV		0x89
+#define HID_CONSUMER_MEDIA_SEL_WWW		0x8A
+#define HID_CONSUMER_MEDIA_SEL_DVD		0x8B
+#define HID_CONSUMER_MEDIA_SEL_TELEPHONE	0x8C
+#define HID_CONSUMER_MEDIA_SEL_PROGRAM_GUIDE	0x8D
+#define HID_CONSUMER_MEDIA_SEL_VIDEO_PHONE	0x8E
+#define HID_CONSUMER_MEDIA_SEL_GAMES	0x8F
+#define HID_CONSUMER_MEDIA_SEL_MESSAGES	0x90
+#define HID_CONSUMER_MEDIA_SEL_CD		0x91
+#define HID_CONSUMER_MEDIA_SEL_VCR		0x92
+#define HID_CONSUMER_MEDIA_SEL_TUNER	0x93
+#define HID_CONSUMER_QUIT				0x94
+#define HID_CONSUMER_HELP				0x95
+#define HID_CONSUMER_MEDIA_SEL_TAPE		0x96
+#define HID_CONSUMER_MEDIA_SEL_CABLE	0x97
+#define HID_CONSUMER_MEDIA_SEL_SATELLITE	0x98
+#define HID_CONSUMER_MEDIA_SEL_SECURITY	0x99
+#define HID_CONSUMER_MEDIA_SEL_HOME		0x9A
+#define HID_CONSUMER_MEDIA_SEL_CALL		0x9B
+#define HID_CONSUMER_CHANNEL_UP			0x9C
+#define HID_CONSUMER_CHANNEL_DOWN		0x9D
+#define HID_CONSUMER_MEDIA_SEL_SAP		0x9E
+#define HID_CONSUMER_VCR_PLUS			0xA0
+#define HID_CONSUMER_ONCE				0xA1
+#define HID_CONSUMER_DAILY				0xA2
+#define HID_CONSUMER_WEEKLY				0xA3
+#define HID_CONSUMER_MONTHLY			0xA4
+
+// Transport
+#define HID_CONSUMER_PLAY				0xB0
+#define HID_CONSUMER_PAUSE				0xB1
+#define HID_CONSUMER_RECORD				0xB2
+#define HID_CONSUMER_FAST_FORWARD		0xB3
+#define HID_CONSUMER_REWIND				0xB4
+#define HID_CONSUMER_SCAN_NEXT_TRK		0xB5
+#define HID_CONSUMER_SCAN_PREV_TRK		0xB6
+#define HID_CONSUMER_STOP				0xB7
+#define HID_CONSUMER_EJECT				0xB8
+#define HID_CONSUMER_RANDOM_PLAY		0xB9
+#define HID_CONSUMER_SELECT_DISC		0xBA
+#define HID_CONSUMER_ENTER_DISC			0xBB
+#define HID_CONSUMER_REPEAT				0xBC
+#define HID_CONSUMER_TRACKING			0xBD
+#define HID_CONSUMER_TRACK_NORMAL		0xBE
+#define HID_CONSUMER_SLOW_TRACKING		0xBF
+#define HID_CONSUMER_FRAME_FORWARD		0xC0
+#define HID_CONSUMER_FRAME_BACK			0xC1
+#define HID_CONSUMER_MARK				0xC2
+#define HID_CONSUMER_CLEAR_MARK			0xC3
+#define HID_CONSUMER_REPEAT_FROM_MARK	0xC4
+#define HID_CONSUMER_RETURN_TO_MARK		0xC5
+#define HID_CONSUMER_SEARCH_MARK_FORWARD	0xC6
+#define HID_CONSUMER_SEARCH_MARK_BACKWARD	0xC7
+#define HID_CONSUMER_COUNTER_RESET		0xC8
+#define HID_CONSUMER_SHOW_COUNTER		0xC9
+#define HID_CONSUMER_TRACKING_INC		0xCA
+#define HID_CONSUMER_TRACKING_DEC		0xCB
+#define HID_CONSUMER_STOP_EJECT			0xCC
+#define HID_CONSUMER_PLAY_PAUSE			0xCD
+#define HID_CONSUMER_PLAY_SKIP			0xCE
+
+// Audio
+#define HID_CONSUMER_VOLUME				0xE0
+#define HID_CONSUMER_BALANCE			0xE1
+#define HID_CONSUMER_MUTE				0xE2
+#define HID_CONSUMER_BASS				0xE3
+#define HID_CONSUMER_TREBLE				0xE4
+#define HID_CONSUMER_BASS_BOOST			0xE5
+#define HID_CONSUMER_SURROUND_MODE		0xE6
+#define HID_CONSUMER_LOUDNESS			0xE7
+#define HID_CONSUMER_MPX				0xE8
+#define HID_CONSUMER_VOLUME_UP			0xE9
+#define HID_CONSUMER_VOLUME_DOWN		0xEA
+#define HID_CONSUMER_SPEED_SELECT		0xF0
+#define HID_CONSUMER_PLAYBACK_SPEED		0xF1
+#define HID_CONSUMER_STANDARD_PLAY		0xF2
+#define HID_CONSUMER_LONG_PLAY			0xF3
+#define HID_CONSUMER_EXTENDED_PLAY		0xF4
+#define HID_CONSUMER_SLOW				0xF5
+
+// Home automation
+#define HID_CONSUMER_FAN_ENABLE			0x100
+#define HID_CONSUMER_FAN_SPEED			0x101
+#define HID_CONSUMER_LIGHT_ENABLE		0x102
+#define HID_CONSUMER_LIGHT_LEVEL		0x103
+#define HID_CONSUMER_CLIMATE_CONTROL_ENABLE	0x104
+#define HID_CONSUMER_ROOM_TEMPERATURE	0x105
+#define HID_CONSUMER_SECURITY_ENABLE	0x106
+#define HID_CONSUMER_FIRE_ALARM			0x107
+#define HID_CONSUMER_POLICE_ALARM		0x108
+#define HID_CONSUMER_PROXIMITY			0x109
+#define HID_CONSUMER_MOTION				0x10A
+#define HID_CONSUMER_DURESS_ALARM		0x10B
+#define HID_CONSUMER_HOLDUP_ALARM		0x10C
+#define HID_CONSUMER_MEDICAL_ALARM		0x10D
+
+// Audio channels
+#define HID_CONSUMER_BALANCE_RIGHT		0x150
+#define HID_CONSUMER_BALANCE_LEFT		0x151
+#define HID_CONSUMER_BASS_UP			0x152
+#define HID_CONSUMER_BASS_DOWN			0x153
+#define HID_CONSUMER_TREBLE_UP			0x154
+#define HID_CONSUMER_TREBLE_DOWN		0x155
+#define HID_CONSUMER_SPEAKER_SYSTEM		0x160
+#define HID_CONSUMER_CHANNEL_LEFT		0x161
+#define HID_CONSUMER_CHANNEL_RIGHT		0x162
+#define HID_CONSUMER_CHANNEL_CENTER		0x163
+#define HID_CONSUMER_CHANNEL_FRONT		0x164
+#define HID_CONSUMER_CHANNEL_CENTER_FRONT	0x165
+#define HID_CONSUMER_CHANNEL_SIDE		0x166
+#define HID_CONSUMER_CHANNEL_SURROUND	0x167
+#define HID_CONSUMER_CHANNEL_LFE		0x168
+#define HID_CONSUMER_CHANNEL_TOP		0x169
+#define HID_CONSUMER_CHANNEL_UNKNOWN	0x16A
+#define HID_CONSUMER_SUB_CHANNEL		0x170
+#define HID_CONSUMER_SUB_CHANNEL_UP		0x171
+#define HID_CONSUMER_SUB_CHANNEL_DOWN	0x172
+#define HID_CONSUMER_ALT_AUDIO_UP		0x173
+#define HID_CONSUMER_ALT_AUDIO_DOWN		0x174
+
+// Application launch (AL)
+#define HID_CONSUMER_AL_LAUNCH_BUTTONS	0x180
+#define HID_CONSUMER_AL_LAUNCH_CONFIG	0x181
+#define HID_CONSUMER_AL_PROGRAMMABLE_CONFIG	0x182
+#define HID_CONSUMER_AL_CONSUMER_CONFIG	0x183
+#define HID_CONSUMER_AL_WORD_PROCESSOR	0x184
+#define HID_CONSUMER_AL_TEXT_EDITOR		0x185
+#define HID_CONSUMER_AL_SPREADSHEET		0x186
+#define HID_CONSUMER_AL_GRAPHICS_EDITOR	0x187
+#define HID_CONSUMER_AL_PRESENTATION	0x188
+#define HID_CONSUMER_AL_DATABASE		0x189
+#define HID_CONSUMER_AL_EMAIL			0x18A
+#define HID_CONSUMER_AL_NEWSREADER		0x18B
+#define HID_CONSUMER_AL_VOICEMAIL		0x18C
+#define HID_CONSUMER_AL_CONTACTS		0x18D
+#define HID_CONSUMER_AL_CALENDAR		0x18E
+#define HID_CONSUMER_AL_TASK_MANAGER	0x18F
+#define HID_CONSUMER_AL_JOURNAL			0x190
+#define HID_CONSUMER_AL_FINANCE			0x191
+#define HID_CONSUMER_AL_CALCULATOR		0x192
+#define HID_CONSUMER_AL_AV_CAPTURE		0x193
+#define HID_CONSUMER_AL_LOCAL_BROWSER	0x194
+#define HID_CONSUMER_AL_LAN_BROWSER		0x195
+#define HID_CONSUMER_AL_INTERNET_BROWSER	0x196
+#define HID_CONSUMER_AL_REMOTE_NETWORKING	0x197
+#define HID_CONSUMER_AL_NETWORK_CONFERENCE	0x198
+#define HID_CONSUMER_AL_NETWORK_CHAT	0x199
+#define HID_CONSUMER_AL_TELEPHONY		0x19A
+#define HID_CONSUMER_AL_LOGON			0x19B
+#define HID_CONSUMER_AL_LOGOFF			0x19C
+#define HID_CONSUMER_AL_LOGON_LOGOFF	0x19D
+#define HID_CONSUMER_AL_TERMINAL_LOCK	0x19E
+#define HID_CONSUMER_AL_CONTROL_PANEL	0x19F
+#define HID_CONSUMER_AL_COMMAND_LINE	0x1A0
+#define HID_CONSUMER_AL_PROCESS_MANAGER	0x1A1
+#define HID_CONSUMER_AL_SELECT_TASK		0x1A2
+#define HID_CONSUMER_AL_NEXT_TASK		0x1A3
+#define HID_CONSUMER_AL_PREVIOUS_TASK	0x1A4
+#define HID_CONSUMER_AL_HALT_TASK		0x1A5
+#define HID_CONSUMER_AL_HELP_CENTER		0x1A6
+#define HID_CONSUMER_AL_DOCUMENTS		0x1A7
+#define HID_CONSUMER_AL_THESAURUS		0x1A8
+#define HID_CONSUMER_AL_DICTIONARY		0x1A9
+#define HID_CONSUMER_AL_DESKTOP			0x1AA
+#define HID_CONSUMER_AL_SPELL_CHECK		0x1AB
+#define HID_CONSUMER_AL_GRAMMAR_CHECK	0x1AC
+#define HID_CONSUMER_AL_WIRELESS_STATUS	0x1AD
+#define HID_CONSUMER_AL_KEYBOARD_LAYOUT	0x1AE
+#define HID_CONSUMER_AL_VIRUS_PROTECTION	0x1AF
+#define HID_CONSUMER_AL_ENCRYPTION		0x1B0
+#define HID_CONSUMER_AL_SCREEN_SAVER	0x1B1
+#define HID_CONSUMER_AL_ALARMS			0x1B2
+#define HID_CONSUMER_AL_CLOCK			0x1B3
+#define HID_CONSUMER_AL_FILE_BROWSER	0x1B4
+#define HID_CONSUMER_AL_POWER_STATUS	0x1B5
+#define HID_CONSUMER_AL_IMAGE_BROWSER	0x1B6
+#define HID_CONSUMER_AL_AUDIO_BROWSER	0x1B7
+#define HID_CONSUMER_AL_MOVIE_BROWSER	0x1B8
+#define HID_CONSUMER_AL_DIGITAL_RIGHTS	0x1B9
+#define HID_CONSUMER_AL_DIGITAL_WALLET	0x1BA
+#define HID_CONSUMER_AL_INSTANT_MESSAGING	0x1BC
+#define HID_CONSUMER_AL_OEM_TIPS		0x1BD
+#define HID_CONSUMER_AL_OEM_HELP		0x1BE
+#define HID_CONSUMER_AL_ONLINE_COMMUNITY	0x1BF
+#define HID_CONSUMER_AL_ENTERTAINMENT_BROWSER	0x1C0
+#define HID_CONSUMER_AL_SHOPPING_BROWSER	0x1C1
+#define HID_CONSUMER_AL_SMARTCARD_HELP	0x1C2
+#define HID_CONSUMER_AL_MARKET_MONITOR	0x1C3
+#define HID_CONSUMER_AL_NEWS_BROWSER	0x1C4
+#define HID_CONSUMER_AL_ONLINE_ACTIVITY	0x1C5
+#define HID_CONSUMER_AL_SEARCH_BROWSER	0x1C6
+#define HID_CONSUMER_AL_AUDIO_PLAYER	0x1C7
 
-#define HID_CONSUMER_CHANNEL_UP		0x9C
-#define HID_CONSUMER_CHANNEL_DOWN	0x9D
-#define HID_CONSUMER_VOLUME_UP		0xE9
-#define HID_CONSUMER_VOLUME_DOWN	0xEA
-#define HID_CONSUMER_MUTE			0xE2
-#define HID_CONSUMER_POWER			0x30
-#define HID_CONSUMER_RECALL_LAST	0x83
-#define HID_CONSUMER_ASSIGN_SEL		0x81
-#define HID_CONSUMER_PLAY			0xB0
-#define HID_CONSUMER_PAUSE			0xB1
-#define HID_CONSUMER_RECORD			0xB2
-#define HID_CONSUMER_FAST_FORWARD	0xB3
-#define HID_CONSUMER_REWIND			0xB4
-#define HID_CONSUMER_SCAN_NEXT_TRK	0xB5
-#define HID_CONSUMER_SCAN_PREV_TRK	0xB6
-#define HID_CONSUMER_STOP			0xB7
+// Application control (AC)
+#define HID_CONSUMER_AC_GENERIC_GUI		0x200
+#define HID_CONSUMER_AC_NEW				0x201
+#define HID_CONSUMER_AC_OPEN			0x202
+#define HID_CONSUMER_AC_CLOSE			0x203
+#define HID_CONSUMER_AC_EXIT			0x204
+#define HID_CONSUMER_AC_MAXIMIZE		0x205
+#define HID_CONSUMER_AC_MINIMIZE		0x206
+#define HID_CONSUMER_AC_SAVE			0x207
+#define HID_CONSUMER_AC_PRINT			0x208
+#define HID_CONSUMER_AC_PROPERTIES		0x209
+#define HID_CONSUMER_AC_UNDO			0x21A
+#define HID_CONSUMER_AC_COPY			0x21B
+#define HID_CONSUMER_AC_CUT				0x21C
+#define HID_CONSUMER_AC_PASTE			0x21D
+#define HID_CONSUMER_AC_SELECT_ALL		0x21E
+#define HID_CONSUMER_AC_FIND			0x21F
+#define HID_CONSUMER_AC_FIND_REPLACE	0x220
+#define HID_CONSUMER_AC_SEARCH			0x221
+#define HID_CONSUMER_AC_GO_TO			0x222
+#define HID_CONSUMER_AC_HOME			0x223
+#define HID_CONSUMER_AC_BACK			0x224
+#define HID_CONSUMER_AC_FORWARD			0x225
+#define HID_CONSUMER_AC_STOP			0x226
+#define HID_CONSUMER_AC_REFRESH			0x227
+#define HID_CONSUMER_AC_PREVIOUS_LINK	0x228
+#define HID_CONSUMER_AC_NEXT_LINK		0x229
+#define HID_CONSUMER_AC_BOOKMARKS		0x22A
+#define HID_CONSUMER_AC_HISTORY			0x22B
+#define HID_CONSUMER_AC_SUBSCRIPTIONS	0x22C
+#define HID_CONSUMER_AC_ZOOM_IN			0x22D
+#define HID_CONSUMER_AC_ZOOM_OUT		0x22E
+#define HID_CONSUMER_AC_ZOOM			0x22F
+#define HID_CONSUMER_AC_FULL_SCREEN		0x230
+#define HID_CONSUMER_AC_NORMAL_VIEW		0x231
+#define HID_CONSUMER_AC_VIEW_TOGGLE		0x232
+#define HID_CONSUMER_AC_SCROLL_UP		0x233
+#define HID_CONSUMER_AC_SCROLL_DOWN		0x234
+#define HID_CONSUMER_AC_SCROLL			0x235
+#define HID_CONSUMER_AC_PAN_LEFT		0x236
+#define HID_CONSUMER_AC_PAN_RIGHT		0x237
+#define HID_CONSUMER_AC_PAN				0x238
+#define HID_CONSUMER_AC_NEW_WINDOW		0x239
+#define HID_CONSUMER_AC_TILE_HORIZONTALLY	0x23A
+#define HID_CONSUMER_AC_TILE_VERTICALLY	0x23B
+#define HID_CONSUMER_AC_FORMAT			0x23C
+#define HID_CONSUMER_AC_EDIT			0x23D
+#define HID_CONSUMER_AC_BOLD			0x23E
+#define HID_CONSUMER_AC_ITALICS			0x23F
+#define HID_CONSUMER_AC_UNDERLINE		0x240
+#define HID_CONSUMER_AC_STRIKETHROUGH	0x241
+#define HID_CONSUMER_AC_SUBSCRIPT		0x242
+#define HID_CONSUMER_AC_SUPERSCRIPT		0x243
+#define HID_CONSUMER_AC_ALL_CAPS		0x244
+#define HID_CONSUMER_AC_ROTATE			0x245
+#define HID_CONSUMER_AC_RESIZE			0x246
+#define HID_CONSUMER_AC_FLIP_HORIZONTAL	0x247
+#define HID_CONSUMER_AC_FLIP_VERTICAL	0x248
+#define HID_CONSUMER_AC_MIRROR_HORIZONTAL	0x249
+#define HID_CONSUMER_AC_MIRROR_VERTICAL	0x24A
+#define HID_CONSUMER_AC_FONT_SELECT		0x24B
+#define HID_CONSUMER_AC_FONT_COLOR		0x24C
+#define HID_CONSUMER_AC_FONT_SIZE		0x24D
+#define HID_CONSUMER_AC_JUSTIFY_LEFT	0x24E
+#define HID_CONSUMER_AC_JUSTIFY_CENTER_H	0x24F
+#define HID_CONSUMER_AC_JUSTIFY_RIGHT	0x250
+#define HID_CONSUMER_AC_JUSTIFY_BLOCK_H	0x251
+#define HID_CONSUMER_AC_JUSTIFY_TOP		0x252
+#define HID_CONSUMER_AC_JUSTIFY_CENTER_V	0x253
+#define HID_CONSUMER_AC_JUSTIFY_BOTTOM	0x254
+#define HID_CONSUMER_AC_JUSTIFY_BLOCK_V	0x255
+#define HID_CONSUMER_AC_INDENT_DECREASE	0x256
+#define HID_CONSUMER_AC_INDENT_INCREASE	0x257
+#define HID_CONSUMER_AC_NUMBERED_LIST	0x258
+#define HID_CONSUMER_AC_RESTART_NUMBERING	0x259
+#define HID_CONSUMER_AC_BULLETED_LIST	0x25A
+#define HID_CONSUMER_AC_PROMOTE			0x25B
+#define HID_CONSUMER_AC_DEMOTE			0x25C
+#define HID_CONSUMER_AC_YES				0x25D
+#define HID_CONSUMER_AC_NO				0x25E
+#define HID_CONSUMER_AC_CANCEL			0x25F
+#define HID_CONSUMER_AC_CATALOG			0x260
+#define HID_CONSUMER_AC_CHECKOUT		0x261
+#define HID_CONSUMER_AC_ADD_TO_CART		0x262
+#define HID_CONSUMER_AC_EXPAND			0x263
+#define HID_CONSUMER_AC_EXPAND_ALL		0x264
+#define HID_CONSUMER_AC_COLLAPSE		0x265
+#define HID_CONSUMER_AC_COLLAPSE_ALL	0x266
+#define HID_CONSUMER_AC_PRINT_PREVIEW	0x267
+#define HID_CONSUMER_AC_PASTE_SPECIAL	0x268
+#define HID_CONSUMER_AC_INSERT_MODE		0x269
+#define HID_CONSUMER_AC_DELETE			0x26A
+#define HID_CONSUMER_AC_LOCK			0x26B
+#define HID_CONSUMER_AC_UNLOCK			0x26C
+#define HID_CONSUMER_AC_PROTECT			0x26D
+#define HID_CONSUMER_AC_UNPROTECT		0x26E
+#define HID_CONSUMER_AC_ATTACH_COMMENT	0x26F
+#define HID_CONSUMER_AC_DELETE_COMMENT	0x270
+#define HID_CONSUMER_AC_VIEW_COMMENT	0x271
+#define HID_CONSUMER_AC_SELECT_WORD		0x272
+#define HID_CONSUMER_AC_SELECT_SENTENCE	0x273
+#define HID_CONSUMER_AC_SELECT_PARAGRAPH	0x274
+#define HID_CONSUMER_AC_SELECT_COLUMN	0x275
+#define HID_CONSUMER_AC_SELECT_ROW		0x276
+#define HID_CONSUMER_AC_SELECT_TABLE	0x277
+#define HID_CONSUMER_AC_SELECT_OBJECT	0x278
+#define HID_CONSUMER_AC_REDO			0x279
+#define HID_CONSUMER_AC_SORT			0x27A
+#define HID_CONSUMER_AC_SORT_ASCENDING	0x27B
+#define HID_CONSUMER_AC_SORT_DESCENDING	0x27C
+#define HID_CONSUMER_AC_FILTER			0x27D
+#define HID_CONSUMER_AC_SET_CLOCK		0x27E
+#define HID_CONSUMER_AC_VIEW_CLOCK		0x27F
+#define HID_CONSUMER_AC_SELECT_TIME_ZONE	0x280
+#define HID_CONSUMER_AC_EDIT_TIME_ZONES	0x281
+#define HID_CONSUMER_AC_SET_ALARM		0x282
+#define HID_CONSUMER_AC_CLEAR_ALARM		0x283
+#define HID_CONSUMER_AC_SNOOZE_ALARM	0x284
+#define HID_CONSUMER_AC_RESET_ALARM		0x285
+#define HID_CONSUMER_AC_SYNCHRONIZE		0x286
+#define HID_CONSUMER_AC_SEND_RECEIVE	0x287
+#define HID_CONSUMER_AC_SEND_TO			0x288
+#define HID_CONSUMER_AC_REPLY			0x289
+#define HID_CONSUMER_AC_REPLY_ALL		0x28A
+#define HID_CONSUMER_AC_FORWARD_MSG		0x28B
+#define HID_CONSUMER_AC_SEND			0x28C
+#define HID_CONSUMER_AC_ATTACH_FILE		0x28D
+#define HID_CONSUMER_AC_UPLOAD			0x28E
+#define HID_CONSUMER_AC_DOWNLOAD		0x28F
+#define HID_CONSUMER_AC_SET_BORDERS		0x290
+#define HID_CONSUMER_AC_INSERT_ROW		0x291
+#define HID_CONSUMER_AC_INSERT_COLUMN	0x292
+#define HID_CONSUMER_AC_INSERT_FILE		0x293
+#define HID_CONSUMER_AC_INSERT_PICTURE	0x294
+#define HID_CONSUMER_AC_INSERT_OBJECT	0x295
+#define HID_CONSUMER_AC_INSERT_SYMBOL	0x296
+#define HID_CONSUMER_AC_SAVE_AND_CLOSE	0x297
+#define HID_CONSUMER_AC_RENAME			0x298
+#define HID_CONSUMER_AC_MERGE			0x299
+#define HID_CONSUMER_AC_SPLIT			0x29A
+#define HID_CONSUMER_AC_DISTRIBUTE_HORIZONTALLY	0x29B
+#define HID_CONSUMER_AC_DISTRIBUTE_VERTICALLY	0x29C
 
+// Highest usage the consumer report descriptor declares.
+#define HID_CONSUMER_USAGE_MAX		HID_CONSUMER_AC_DISTRIBUTE_VERTICALLY
 
 
 #endif /* USB_HID_CONSUMER_H_ */
\ No newline at end of file
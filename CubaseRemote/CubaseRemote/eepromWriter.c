@@ -0,0 +1,133 @@
+/*
+ * eepromWriter.c
+ *
+ * An EEPROM byte write takes about 8.5 ms on the ATmega8A, and every
+ * avr-libc access waits for the previous one. Writes are therefore only
+ * started from the main loop when the EEPROM is idle, one byte per pass,
+ * so usbPoll() keeps its timing while data is being persisted. Bytes that
+ * already hold the wanted value are skipped without a write.
+ *
+ * Created: 17-Oct-26 6:03:15 PM
+ */ 
+
+#include <avr/eeprom.h>
+
+#include "eepromWriter.h"
+
+typedef struct
+{
+	uint8_t *dst;			// next EEPROM byte
+	const uint8_t *src;		// its RAM mirror
+	uint16_t len;			// bytes left, 0 = slot free
+} EEPROM_REGION;
+
+static EEPROM_REGION _regions[EEPROM_WRITER_SLOTS];
+
+void eepromWriter_init(void)
+{
+	for(uint8_t i = 0; i < EEPROM_WRITER_SLOTS; i++)
+	{
+		_regions[i].len = 0;
+	}
+}
+
+// Joins [dst, dst + len) into 'region' if both copy from the same mirror
+// and the ranges touch. The union restarts at the lower start, so bytes
+// already written are checked again against their new value.
+static bool eepromWriter_merge(EEPROM_REGION *region, uint8_t *dst, const uint8_t *src, uint16_t len)
+{
+	uint8_t *end = dst + len;
+	uint8_t *regionEnd = region->dst + region->len;
+	
+	if((uintptr_t)region->src - (uintptr_t)region->dst != (uintptr_t)src - (uintptr_t)dst
+		|| end < region->dst || dst > regionEnd)
+	{
+		return false;
+	}
+	if(dst < region->dst)
+	{
+		region->dst = dst;
+		region->src = src;
+	}
+	if(end > regionEnd)
+	{
+		regionEnd = end;
+	}
+	region->len = regionEnd - region->dst;
+	return true;
+}
+
+bool eepromWriter_write(void *dst, const void *src, uint16_t len)
+{
+	EEPROM_REGION *slot = NULL;
+	
+	if(len == 0)
+	{
+		return true;
+	}
+	for(uint8_t i = 0; i < EEPROM_WRITER_SLOTS; i++)
+	{
+		if(_regions[i].len == 0)
+		{
+			if(slot == NULL)
+			{
+				slot = &_regions[i];
+			}
+		}
+		else if(eepromWriter_merge(&_regions[i], dst, src, len))
+		{
+			return true;
+		}
+	}
+	if(slot == NULL)
+	{
+		return false;
+	}
+	slot->dst = dst;
+	slot->src = src;
+	slot->len = len;
+	return true;
+}
+
+void eepromWriter_routine(void)
+{
+	uint8_t checks = EEPROM_WRITER_CHECKS;
+	
+	if(!eeprom_is_ready())
+	{
+		return;
+	}
+	for(uint8_t i = 0; i < EEPROM_WRITER_SLOTS; i++)
+	{
+		EEPROM_REGION *region = &_regions[i];
+		
+		while(region->len != 0)
+		{
+			uint8_t value = *region->src;
+			bool changed = eeprom_read_byte(region->dst) != value;
+			
+			if(changed)
+			{
+				eeprom_write_byte(region->dst, value);
+			}
+			region->dst++;
+			region->src++;
+			region->len--;
+			if(changed || --checks == 0)
+			{
+				return;
+			}
+		}
+	}
+}
+
+uint16_t eepromWriter_get_pending(void)
+{
+	uint16_t pending = 0;
+	
+	for(uint8_t i = 0; i < EEPROM_WRITER_SLOTS; i++)
+	{
+		pending += _regions[i].len;
+	}
+	return pending;
+}
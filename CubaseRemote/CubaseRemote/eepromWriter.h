@@ -0,0 +1,36 @@
+/*
+ * eepromWriter.h
+ *
+ * Created: 17-Oct-26 6:02:44 PM
+ */ 
+
+
+#ifndef EEPROMWRITER_H_
+#define EEPROMWRITER_H_
+
+#include "globals.h"
+
+// Regions waiting to be written; overlapping requests share one.
+#define EEPROM_WRITER_SLOTS			4
+
+// Unchanged bytes skipped per pass at most, reading one takes a few cycles.
+#define EEPROM_WRITER_CHECKS		8
+
+void eepromWriter_init(void);
+
+// Queues a copy of RAM 'src' to EEMEM 'dst'. The bytes are taken from
+// 'src' when they are written, so 'src' must stay valid, and changing it
+// again before the copy is done only moves the result forward. A request
+// that overlaps a queued one for the same RAM mirror joins it.
+// Returns false if every slot holds another region.
+bool eepromWriter_write(void *dst, const void *src, uint16_t len);
+
+// Starts at most one byte write, and never waits for the EEPROM. Call
+// once per main loop pass.
+void eepromWriter_routine(void);
+
+// Bytes queued but not yet compared or written.
+uint16_t eepromWriter_get_pending(void);
+
+
+#endif /* EEPROMWRITER_H_ */
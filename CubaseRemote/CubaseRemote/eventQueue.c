@@ -0,0 +1,94 @@
+/*
+ * eventQueue.c
+ *
+ * Single-producer/single-consumer ring between input scanning and report
+ * generation. The producer only writes _head and the consumer only writes
+ * _tail; both are single bytes, so either side may run in an ISR.
+ *
+ * Created: 17-Oct-26 11:06:30 AM
+ */ 
+
+#include "eventQueue.h"
+
+#define EVENT_QUEUE_MASK (EVENT_QUEUE_SIZE - 1)
+
+static volatile INPUT_EVENT _events[EVENT_QUEUE_SIZE];
+static volatile uint8_t _head;
+static volatile uint8_t _tail;
+static volatile uint8_t _overflowCount;
+
+void eventQueue_init(void)
+{
+	_head = 0;
+	_tail = 0;
+	_overflowCount = 0;
+}
+
+bool eventQueue_push(EVENT_TYPE type, uint8_t value, uint8_t layer, uint16_t timestamp)
+{
+	uint8_t head = _head;
+	
+	if((uint8_t)(head - _tail) >= EVENT_QUEUE_SIZE)
+	{
+		if(_overflowCount != 0xFF)
+		{
+			_overflowCount++;
+		}
+		return false;
+	}
+	
+	volatile INPUT_EVENT *event = &_events[head & EVENT_QUEUE_MASK];
+	event->type = type;
+	event->value = value;
+	event->layer = layer;
+	event->timestamp = timestamp;
+	
+	_head = head + 1;
+	return true;
+}
+
+uint8_t eventQueue_get_free(void)
+{
+	return EVENT_QUEUE_SIZE - (uint8_t)(_head - _tail);
+}
+
+bool eventQueue_peek(uint8_t index, INPUT_EVENT *event)
+{
+	uint8_t tail = _tail;
+	
+	if((uint8_t)(_head - tail) <= index)
+	{
+		return false;
+	}
+	
+	volatile INPUT_EVENT *slot = &_events[(uint8_t)(tail + index) & EVENT_QUEUE_MASK];
+	event->type = slot->type;
+	event->value = slot->value;
+	event->layer = slot->layer;
+	event->timestamp = slot->timestamp;
+	return true;
+}
+
+void eventQueue_remove(uint8_t index)
+{
+	uint8_t tail = _tail;
+	
+	// Move the older events up by one over the removed one. Only slots
+	// between _tail and the event are written, which the producer never
+	// touches.
+	for(uint8_t i = index; i != 0; i--)
+	{
+		volatile INPUT_EVENT *to = &_events[(uint8_t)(tail + i) & EVENT_QUEUE_MASK];
+		volatile INPUT_EVENT *from = &_events[(uint8_t)(tail + i - 1) & EVENT_QUEUE_MASK];
+		to->type = from->type;
+		to->value = from->value;
+		to->layer = from->layer;
+		to->timestamp = from->timestamp;
+	}
+	_tail = tail + 1;
+}
+
+uint8_t eventQueue_get_overflow_count(void)
+{
+	return _overflowCount;
+}
@@ -0,0 +1,50 @@
+/*
+ * eventQueue.h
+ *
+ * Created: 17-Oct-26 11:05:48 AM
+ */ 
+
+
+#ifndef EVENTQUEUE_H_
+#define EVENTQUEUE_H_
+
+#include "globals.h"
+
+// Must be a power of two, at most 128.
+#define EVENT_QUEUE_SIZE 32
+
+typedef enum _EVENT_TYPE
+{
+	EVENT_KEY_PRESSED	= 1,
+	EVENT_KEY_RELEASED	= 2,
+	EVENT_ENCODER		= 3,
+} EVENT_TYPE;
+
+typedef struct
+{
+	uint8_t type;
+	uint8_t value;			// button (see keyboard.h), or the signed step count for EVENT_ENCODER
+	uint8_t layer;			// keymap layer the input was taken in
+	uint16_t timestamp;		// timer2_get_samples() of the input edge
+} INPUT_EVENT;
+
+void eventQueue_init(void);
+
+// Producer side. Returns false and counts an overflow if the queue is full.
+bool eventQueue_push(EVENT_TYPE type, uint8_t value, uint8_t layer, uint16_t timestamp);
+
+// Producer side. How many pushes in a row cannot overflow.
+uint8_t eventQueue_get_free(void);
+
+// Consumer side. Copies the index-th queued event, 0 being the oldest.
+// Returns false if fewer events are queued.
+bool eventQueue_peek(uint8_t index, INPUT_EVENT *event);
+
+// Consumer side. Removes the index-th queued event; the others keep their
+// order, so an event that has to wait need not hold up those behind it.
+void eventQueue_remove(uint8_t index);
+
+uint8_t eventQueue_get_overflow_count(void);
+
+
+#endif /* EVENTQUEUE_H_ */
\ No newline at end of file
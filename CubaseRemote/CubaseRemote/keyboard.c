@@ -5,80 +5,331 @@
  *  Author: Vlad
  */ 
 
+#include <avr/pgmspace.h>
+
 #include "globals.h"
 
 #include "keyboard.h"
+#include "keymap.h"
+#include "eventQueue.h"
+#include "macro.h"
+#include "timer2.h"
+#include "profiler.h"
+#include "reportScheduler.h"
 #include "USB/usb_hid_keys.h"
-#include "USB/usb_hid_consumer.h"
 
-enum KEYBOARD_MAP_MDOE
-{
-	ON_PRESSED = 1,		
-};
+// Gestures are timed from the debounced edges in timer2 samples, so a
+// late main loop pass does not move a threshold.
+#define KEYBOARD_MS_TO_SAMPLES(ms)		((ms) * TIMER2_SAMPLES_PER_TICK / TIMER2_TICK_MS)
+#define KEYBOARD_HOLD_SAMPLES			KEYBOARD_MS_TO_SAMPLES(200)
+#define KEYBOARD_LONG_PRESS_SAMPLES		KEYBOARD_MS_TO_SAMPLES(500)
+#define KEYBOARD_DOUBLE_TAP_SAMPLES		KEYBOARD_MS_TO_SAMPLES(250)
+
+// Most events one pass over the buttons can queue: two per button, a tap
+// or a press and a release. Buttons only take their edges with this much
+// room and the encoder never eats into it, so no edge is ever lost.
+#define KEYBOARD_BUTTON_EVENTS_MAX	(2 * BUTTON_COUNT)
 
-struct KEYBOARD_KEY {
-	const BUTTON btn;
-	const enum KEYBOARD_MAP_MDOE mode;
-	const uint8_t hidCode;
-	uint8_t lastState;
-	bool hasPendingAction;
+// Indexed by ACTION_TYPE. A macro goes out in the keyboard report, but
+// step by step from macro.c rather than as a held key.
+static const uint8_t _actionClass[ACTION_TYPE_COUNT] PROGMEM =
+{
+	[ACTION_KEY]		= REPORT_ID_KEYBOARD | ACTION_CLASS_HELD,
+	[ACTION_MACRO]		= REPORT_ID_KEYBOARD,
+	[ACTION_CONSUMER]	= REPORT_ID_CONSUMER | ACTION_CLASS_HELD,
+	[ACTION_LAYER]		= ACTION_CLASS_LAYER,
+	[ACTION_LAYER_LOCK]	= ACTION_CLASS_LAYER,
+	[ACTION_WHEEL]		= REPORT_ID_MOUSE | ACTION_CLASS_RELATIVE,
 };
 
-static struct KEYBOARD_KEY keyboardMap[] =
+enum GESTURE_STATE
 {
-	{Button_1,		ON_PRESSED, KEY_NONE,				0xFF, false},
-	{Button_2,		ON_PRESSED, KEY_NONE,				0xFF, false},              
-	{Button_3,		ON_PRESSED, KEY_KPASTERISK,			0xFF, false},
-	{Button_4,		ON_PRESSED, KEY_S,					0xFF, false},
-	{Button_5,		ON_PRESSED, KEY_KPSLASH,			0xFF, false},
-	{Button_6,		ON_PRESSED, KEY_SPACE,				0xFF, false},
-	{Button_ENC,	ON_PRESSED, HID_CONSUMER_MUTE,		0xFF, false}
+	GESTURE_IDLE,
+	GESTURE_DOWN,		// pressed, not decided yet
+	GESTURE_UP,			// tapped once, waiting for a second press
+	GESTURE_ALT_DOWN,	// alt is held until release
+	GESTURE_DONE,		// decided, release is ignored
 };
 
+static uint8_t _gestureState[BUTTON_COUNT];
+static uint16_t _gestureSince[BUTTON_COUNT];	// timer2_get_samples()
+static uint8_t _gestureTimed;	// buttons whose state waits for a timeout
+
+static uint8_t _layerHeld;		// layer of the held ACTION_LAYER key, base if none
+static uint8_t _layerLocked;
+static uint8_t _pressLayer[BUTTON_COUNT];	// layer a button's gesture started in
+static uint16_t _eventTime;		// timestamp for the events pushed next, see INPUT_EVENT
+
 void keyboard_init(void)
 {
+	eventQueue_init();
+	keymap_init();
+	macro_init();
 	button_init();
 	//encoder_init();
 	rotaryEncoder_init();
 }
 
-static void keyboard_process_buttons(void)
+// A gesture whose alt key is down still ends with its release, which
+// the report scheduler waits for.
+void keyboard_reset(void)
+{
+	for(uint8_t btn = 0; btn < BUTTON_COUNT; btn++)
+	{
+		if(_gestureState[btn] != GESTURE_ALT_DOWN)
+		{
+			_gestureState[btn] = GESTURE_IDLE;
+		}
+	}
+	_gestureTimed = 0;
+	_layerHeld = KEYBOARD_LAYER_BASE;
+	_layerLocked = KEYBOARD_LAYER_BASE;
+}
+
+static uint8_t keyboard_layer(void)
+{
+	return _layerHeld != KEYBOARD_LAYER_BASE ? _layerHeld : _layerLocked;
+}
+
+static bool keyboard_is_mapped(const KEYBOARD_ACTION *action)
+{
+	return action->type != ACTION_KEY || action->hidCode != KEY_NONE || action->modifiers != 0;
+}
+
+// Key events carry the layer the button went down in, so its release and
+// any late gesture resolve to the same entry even if the layer changed.
+// Cannot overflow, see KEYBOARD_BUTTON_EVENTS_MAX.
+static void keyboard_push(EVENT_TYPE type, uint8_t key)
+{
+	eventQueue_push(type, key, _pressLayer[KEYBOARD_EVENT_KEY(key)], _eventTime);
+}
+
+static void keyboard_tap(uint8_t key)
+{
+	keyboard_push(EVENT_KEY_PRESSED, key);
+	keyboard_push(EVENT_KEY_RELEASED, key);
+}
+
+static void keyboard_layer_edge(const KEYBOARD_ACTION *action, bool pressed)
 {
-	for(uint8_t i = 0; i < sizeof(keyboardMap) / sizeof(keyboardMap[0]); i++)
+	if(action->type == ACTION_LAYER)
 	{
-		struct KEYBOARD_KEY *key = &keyboardMap[i];
-		uint8_t btn_state = button_is_pressed(key->btn);
-		if (key->mode == ON_PRESSED)
+		_layerHeld = pressed ? action->hidCode : KEYBOARD_LAYER_BASE;
+	}
+	else if(pressed)
+	{
+		_layerLocked = _layerLocked == action->hidCode ? KEYBOARD_LAYER_BASE : action->hidCode;
+	}
+}
+
+static void keyboard_set_gesture(uint8_t btn, uint8_t state, uint16_t now)
+{
+	_gestureState[btn] = state;
+	_gestureSince[btn] = now;
+	if(state == GESTURE_DOWN || state == GESTURE_UP)
+	{
+		_gestureTimed |= 1 << btn;
+	}
+	else
+	{
+		_gestureTimed &= ~(1 << btn);
+	}
+}
+
+static void keyboard_gesture_edge(uint8_t btn, uint8_t mode, bool pressed, uint16_t now)
+{
+	uint8_t state = _gestureState[btn];
+	
+	if(pressed)
+	{
+		if(mode == DOUBLE_TAP && state == GESTURE_UP)
 		{
-			if(key->lastState == false && btn_state == true)
+			keyboard_push(EVENT_KEY_PRESSED, btn | KEYBOARD_EVENT_ALT);
+			keyboard_set_gesture(btn, GESTURE_ALT_DOWN, now);
+		}
+		else if(mode != ON_RELEASED)
+		{
+			keyboard_set_gesture(btn, GESTURE_DOWN, now);
+		}
+		return;
+	}
+	
+	if(state == GESTURE_ALT_DOWN)
+	{
+		keyboard_push(EVENT_KEY_RELEASED, btn | KEYBOARD_EVENT_ALT);
+	}
+	else if(mode == ON_RELEASED || state == GESTURE_DOWN)
+	{
+		if(mode == DOUBLE_TAP)
+		{
+			keyboard_set_gesture(btn, GESTURE_UP, now);
+			return;
+		}
+		keyboard_tap(btn);
+	}
+	keyboard_set_gesture(btn, GESTURE_IDLE, now);
+}
+
+static void keyboard_gesture_timeout(uint8_t btn, uint8_t mode, uint16_t now)
+{
+	uint16_t elapsed = now - _gestureSince[btn];
+	
+	switch(mode)
+	{
+		case LONG_PRESS:
+			if(elapsed >= KEYBOARD_LONG_PRESS_SAMPLES)
 			{
-				key->hasPendingAction = true;
+				keyboard_tap(btn | KEYBOARD_EVENT_ALT);
+				keyboard_set_gesture(btn, GESTURE_DONE, now);
 			}
-		}
+			break;
+		
+		case TAP_HOLD:
+			if(elapsed >= KEYBOARD_HOLD_SAMPLES)
+			{
+				keyboard_push(EVENT_KEY_PRESSED, btn | KEYBOARD_EVENT_ALT);
+				keyboard_set_gesture(btn, GESTURE_ALT_DOWN, now);
+			}
+			break;
+		
+		case DOUBLE_TAP:
+			if(_gestureState[btn] == GESTURE_UP && elapsed >= KEYBOARD_DOUBLE_TAP_SAMPLES)
+			{
+				keyboard_tap(btn);
+				keyboard_set_gesture(btn, GESTURE_IDLE, now);
+			}
+			break;
 		
-		key->lastState = btn_state;
+		default:
+			break;
 	}
 }
 
-void keyboard_routine(void)
+static void keyboard_button_edge(uint8_t btn, bool pressed, uint16_t now)
 {
-	button_routine();
-	//encoder_routine();
-	rotaryEncoder_process();
-	keyboard_process_buttons();
+	const struct KEYBOARD_KEY *key;
+	
+	// A timeout that ran out before the edge was debounced comes first,
+	// however late this pass is.
+	if(_gestureTimed & (1 << btn))
+	{
+		key = keymap_get_key(_pressLayer[btn], btn);
+		keyboard_gesture_timeout(btn, key->mode, now);
+	}
+	// A gesture waiting for its second press keeps its layer.
+	if(pressed && _gestureState[btn] == GESTURE_IDLE)
+	{
+		_pressLayer[btn] = keyboard_layer();
+	}
+	key = keymap_get_key(_pressLayer[btn], btn);
+	if (!keyboard_is_mapped(&key->action))
+	{
+		return;
+	}
+	
+	if (keyboard_get_action_class(&key->action) & ACTION_CLASS_LAYER)
+	{
+		keyboard_layer_edge(&key->action, pressed);
+	}
+	else if (key->mode == ON_PRESSED)
+	{
+		// Nothing to tell apart, so the press goes out at once.
+		keyboard_push(pressed ? EVENT_KEY_PRESSED : EVENT_KEY_RELEASED, btn);
+	}
+	else
+	{
+		keyboard_gesture_edge(btn, key->mode, pressed, now);
+	}
 }
 
-uint8_t keyboard_get_pressed_key(void)
+static void keyboard_process_buttons(void)
 {
-	for(uint8_t i = 0; i < sizeof(keyboardMap) / sizeof(keyboardMap[0]); i++)
+	uint8_t pressed;
+	uint8_t released;
+	uint8_t active;
+	
+	// Without room for every event this pass could queue, the edges wait in
+	// the debouncer.
+	if(eventQueue_get_free() < KEYBOARD_BUTTON_EVENTS_MAX)
+	{
+		return;
+	}
+	pressed = button_take_pressed();
+	released = button_take_released();
+	active = pressed | released | _gestureTimed;
+	if(active == 0)
+	{
+		return;
+	}
+	
+	for(uint8_t btn = 0; btn < BUTTON_COUNT; btn++)
 	{
-		struct KEYBOARD_KEY *key = &keyboardMap[i];
+		uint8_t mask = 1 << btn;
+		if(!(active & mask))
+		{
+			continue;
+		}
+		// Edge events date from the debounced edge, timeout events from
+		// the timeout.
+		_eventTime = button_get_edge_time(btn);
 		
-		if(key->hasPendingAction == true)
+		if((pressed & released) & mask)
+		{
+			// Both edges waited; the level tells which one came last.
+			bool down = button_is_pressed(btn);
+			keyboard_button_edge(btn, !down, _eventTime);
+			keyboard_button_edge(btn, down, _eventTime);
+		}
+		else if((pressed | released) & mask)
+		{
+			keyboard_button_edge(btn, (pressed & mask) != 0, _eventTime);
+		}
+		if(_gestureTimed & mask)
+		{
+			const struct KEYBOARD_KEY *key = keymap_get_key(_pressLayer[btn], btn);
+			_eventTime = timer2_get_samples();
+			keyboard_gesture_timeout(btn, key->mode, _eventTime);
+		}
+	}
+}
+
+static void keyboard_process_encoder(void)
+{
+	// Steps stay in the encoder accumulator until the queue can take them
+	// and still keep the buttons' room.
+	if(eventQueue_get_free() > KEYBOARD_BUTTON_EVENTS_MAX)
+	{
+		uint16_t since;
+		int8_t delta = rotaryEncoder_take_delta(&since);
+		if(delta != 0)
 		{
-			key->hasPendingAction = false;
-			return key->hidCode;
+			eventQueue_push(EVENT_ENCODER, (uint8_t)delta, keyboard_layer(), since);
 		}
 	}
-	return 0;
+}
+
+void keyboard_routine(void)
+{
+	//encoder_routine();
+	PROFILE(PROFILE_ENCODER_EVENTS, keyboard_process_encoder());
+	PROFILE(PROFILE_BUTTON_EVENTS, keyboard_process_buttons());
+}
+
+uint8_t keyboard_get_action_class(const KEYBOARD_ACTION *action)
+{
+	return pgm_read_byte(&_actionClass[action->type]);
+}
+
+void keyboard_get_action(uint8_t layer, uint8_t key, KEYBOARD_ACTION *action)
+{
+	const struct KEYBOARD_KEY *entry = keymap_get_key(layer, KEYBOARD_EVENT_KEY(key));
+	
+	*action = (key & KEYBOARD_EVENT_ALT) ? entry->alt : entry->action;
+}
+
+void keyboard_get_encoder_action(uint8_t layer, bool clockwise, KEYBOARD_ACTION *action)
+{
+	const KEYBOARD_LAYER *entry = keymap_get_layer(layer);
+	
+	*action = clockwise ? entry->encoderCw : entry->encoderCcw;
 }
@@ -12,11 +12,66 @@
 #include "Button_debounce.h"
 #include "rotaryEncoder.h"
 
+#define KEYBOARD_MAX_KEYS	8	// buttons are tracked as bits of a uint8_t
+
+// Keymap banks, see keymapDefaults[] in keymap.c. A held layer key wins
+// over a locked layer, so the base layer is only active with neither.
+#define KEYBOARD_LAYER_BASE		0
+#define KEYBOARD_LAYER_ZOOM		1	// while Button_2 is held
+#define KEYBOARD_LAYER_JOG		2	// locked from the zoom layer with the encoder switch
+#define KEYBOARD_LAYER_COUNT	3
+
+// Key event values are buttons; this flag selects the entry's alt
+// action, fired by a gesture (double tap, long press, hold).
+#define KEYBOARD_EVENT_ALT		0x80
+#define KEYBOARD_EVENT_KEY(v)	((v) & ~KEYBOARD_EVENT_ALT)
+
+typedef enum _ACTION_TYPE
+{
+	ACTION_KEY = 0,			// modifiers + hidCode in the keyboard report
+	ACTION_MACRO = 1,		// hidCode is a macro id, see macro.h
+	ACTION_CONSUMER = 2,	// modifiers:hidCode is a 16-bit usage in the consumer report
+	ACTION_LAYER = 3,		// hidCode is the layer active while the key is held
+	ACTION_LAYER_LOCK = 4,	// hidCode is the layer locked, or unlocked if it already is
+	ACTION_WHEEL = 5,		// encoder only: hidCode is a MOUSE_AXIS, modifiers the signed wheel units per step
+	ACTION_TYPE_COUNT
+} ACTION_TYPE;
+
+// What an action type does, from keyboard_get_action_class(). A new type
+// is a row in the class table, not another branch at every use.
+#define ACTION_CLASS_REPORT(c)	((c) & 0x0F)	// report ID it goes out in, 0 for none
+#define ACTION_CLASS_HELD		0x10			// in its report for as long as the key is down
+#define ACTION_CLASS_LAYER		0x20			// handled by keyboard.c, never queued
+#define ACTION_CLASS_RELATIVE	0x40			// a motion, any number of steps go out in one report
+
+typedef struct
+{
+	uint8_t type;			// ACTION_TYPE
+	uint8_t modifiers;		// KEY_MOD_* mask
+	uint8_t hidCode;
+} KEYBOARD_ACTION;
+
+// A consumer action has no modifiers, so that byte holds the high byte of
+// its usage; usages up to 0xFF read the same as a plain hidCode.
+#define KEYBOARD_CONSUMER_ACTION(usage)	{ACTION_CONSUMER, (uint8_t)((usage) >> 8), (uint8_t)(usage)}
+#define KEYBOARD_ACTION_USAGE(action)	((uint16_t)(action)->modifiers << 8 | (action)->hidCode)
+
 void keyboard_init(void);
 
 void keyboard_routine(void);
 
-uint8_t keyboard_get_pressed_key(void);
+// Drops the layers and the gestures in progress when the keymap changes.
+void keyboard_reset(void);
+
+// Class of a valid action, a mix of the ACTION_CLASS_* above.
+uint8_t keyboard_get_action_class(const KEYBOARD_ACTION *action);
+
+// Looks up the keymap action a key event taken in 'layer' refers to.
+void keyboard_get_action(uint8_t layer, uint8_t key, KEYBOARD_ACTION *action);
+
+// Looks up the action one encoder step in 'layer' sends, for a positive
+// (clockwise) or negative step count.
+void keyboard_get_encoder_action(uint8_t layer, bool clockwise, KEYBOARD_ACTION *action);
 
 
 #endif /* BUTTON_MAP_H_ */
\ No newline at end of file
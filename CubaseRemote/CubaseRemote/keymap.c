@@ -0,0 +1,365 @@
+/*
+ * keymap.c
+ *
+ * The keymap (key layers, macros and the encoder acceleration curve)
+ * lives in EEPROM behind a version and CRC header and is
+ * copied to RAM at boot, so lookups never wait on EEPROM. The host reads
+ * and replaces it with the REPORT_ID_KEYMAP feature report; a new map
+ * takes effect at once and is written back by the EEPROM writer.
+ *
+ * Created: 17-Oct-26 5:11:02 PM
+ */ 
+
+#include <stddef.h>
+#include <string.h>
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <util/crc16.h>
+
+#include "keymap.h"
+#include "eepromWriter.h"
+#include "macro.h"
+#include "reportScheduler.h"
+#include "USB/usb_hid_keys.h"
+#include "USB/usb_hid_consumer.h"
+
+// Every layer spells out every button, so a lookup is a single read at
+// [layer][button] however many layers there are.
+static const KEYBOARD_LAYER keymapDefaults[KEYBOARD_LAYER_COUNT] PROGMEM =
+{
+	[KEYBOARD_LAYER_BASE] =
+	{
+		{
+			[Button_1]		= {ON_PRESSED, {ACTION_MACRO,		0,	MACRO_SELECT_SOLO_PLAY}},
+			[Button_2]		= {ON_PRESSED, {ACTION_LAYER,		0,	KEYBOARD_LAYER_ZOOM}},
+			[Button_3]		= {ON_PRESSED, {ACTION_KEY,			0,	KEY_KPASTERISK}},
+			[Button_4]		= {ON_PRESSED, {ACTION_KEY,			0,	KEY_S}},
+			[Button_5]		= {ON_PRESSED, {ACTION_KEY,			0,	KEY_KPSLASH}},
+			[Button_6]		= {ON_PRESSED, {ACTION_KEY,			0,	KEY_SPACE}},
+			[Button_ENC]	= {ON_PRESSED, KEYBOARD_CONSUMER_ACTION(HID_CONSUMER_MUTE)},
+		},
+		KEYBOARD_CONSUMER_ACTION(HID_CONSUMER_VOLUME_DOWN),
+		KEYBOARD_CONSUMER_ACTION(HID_CONSUMER_VOLUME_UP),
+	},
+	// Cubase zoom: G / H zoom out / in, Shift+F zooms to the full project.
+	[KEYBOARD_LAYER_ZOOM] =
+	{
+		{
+			[Button_1]		= {ON_PRESSED, {ACTION_KEY,			KEY_MOD_LSHIFT,	KEY_F}},
+			[Button_2]		= {ON_PRESSED, {ACTION_LAYER,		0,	KEYBOARD_LAYER_ZOOM}},
+			[Button_3]		= {ON_PRESSED, {ACTION_KEY,			0,	KEY_KPASTERISK}},
+			[Button_4]		= {ON_PRESSED, {ACTION_KEY,			0,	KEY_S}},
+			[Button_5]		= {ON_PRESSED, {ACTION_KEY,			0,	KEY_KPSLASH}},
+			[Button_6]		= {ON_PRESSED, {ACTION_KEY,			0,	KEY_SPACE}},
+			[Button_ENC]	= {ON_PRESSED, {ACTION_LAYER_LOCK,	0,	KEYBOARD_LAYER_JOG}},
+		},
+		{ACTION_KEY,	0,	KEY_G},
+		{ACTION_KEY,	0,	KEY_H},
+	},
+	// Cubase jog: keypad - / + rewind and fast forward, the encoder switch
+	// unlocks the layer again. Record, stop and play go out as media keys,
+	// which reach the host's transport without Cubase having the focus.
+	[KEYBOARD_LAYER_JOG] =
+	{
+		{
+			[Button_1]		= {ON_PRESSED, {ACTION_MACRO,		0,	MACRO_SELECT_SOLO_PLAY}},
+			[Button_2]		= {ON_PRESSED, {ACTION_LAYER,		0,	KEYBOARD_LAYER_ZOOM}},
+			[Button_3]		= {ON_PRESSED, KEYBOARD_CONSUMER_ACTION(HID_CONSUMER_RECORD)},
+			[Button_4]		= {ON_PRESSED, KEYBOARD_CONSUMER_ACTION(HID_CONSUMER_STOP)},
+			[Button_5]		= {ON_PRESSED, {ACTION_KEY,			0,	KEY_KPSLASH}},
+			[Button_6]		= {ON_PRESSED, KEYBOARD_CONSUMER_ACTION(HID_CONSUMER_PLAY_PAUSE)},
+			[Button_ENC]	= {ON_PRESSED, {ACTION_LAYER_LOCK,	0,	KEYBOARD_LAYER_JOG}},
+		},
+		{ACTION_KEY,	0,	KEY_KPMINUS},
+		{ACTION_KEY,	0,	KEY_KPPLUS},
+	},
+};
+
+static const uint8_t macroDefaults[] PROGMEM =
+{
+	// MACRO_SELECT_SOLO_PLAY: select the track above, solo it, start playback
+	MACRO_STEP(0, KEY_UP,		20),
+	MACRO_STEP(0, KEY_S,		20),
+	MACRO_STEP(0, KEY_SPACE,	0),
+	MACRO_END,
+};
+
+static const struct ENCODER_ACCEL_POINT accelCurveDefaults[ENCODER_ACCEL_POINTS] PROGMEM = ENCODER_ACCEL_CURVE;
+
+static KEYMAP_IMAGE _eeKeymap EEMEM;
+
+static KEYMAP_IMAGE _keymap;		// active map
+static uint8_t _transferOffset;		// bytes of the report moved so far
+
+// A map being received goes into _keymap entry by entry, each checked
+// before it is stored, so lookups in between never see an invalid one.
+static uint8_t _entry[sizeof(struct KEYBOARD_KEY)];	// the entry being received
+static uint8_t _entryFill;			// its bytes received so far
+static uint16_t _incomingCrc;		// header of the map being received
+static uint16_t _crc;				// running over the entries received
+static bool _receiving;				// _keymap holds part of a map being received
+
+static uint16_t keymap_crc(const KEYMAP_IMAGE *image)
+{
+	const uint8_t *data = (const uint8_t *)image->layers;
+	uint16_t crc = 0xFFFF;
+	
+	for(uint16_t i = 0; i < sizeof(*image) - offsetof(KEYMAP_IMAGE, layers); i++)
+	{
+		crc = _crc16_update(crc, data[i]);
+	}
+	return crc;
+}
+
+// Action types index the action class table and layer actions the layer
+// table, so a bad one must never get in. Consumer usages stay within the
+// report descriptor's range, and a macro id within as many macros as the
+// macro area could hold; the macros may not have arrived yet.
+static bool keymap_is_valid_action(const KEYBOARD_ACTION *action)
+{
+	if(action->type >= ACTION_TYPE_COUNT)
+	{
+		return false;
+	}
+	if(action->type == ACTION_WHEEL)
+	{
+		return action->hidCode < MOUSE_AXIS_COUNT;
+	}
+	if(action->type == ACTION_CONSUMER)
+	{
+		return KEYBOARD_ACTION_USAGE(action) <= HID_CONSUMER_USAGE_MAX;
+	}
+	if(action->type == ACTION_MACRO)
+	{
+		return action->hidCode < KEYMAP_MACRO_STEPS;
+	}
+	return !(keyboard_get_action_class(action) & ACTION_CLASS_LAYER) || action->hidCode < KEYBOARD_LAYER_COUNT;
+}
+
+// A button is a held key, a macro or a layer switch; an encoder step a
+// one-shot held key or a wheel motion.
+static bool keymap_is_valid_key(const KEYBOARD_ACTION *action)
+{
+	return keymap_is_valid_action(action) && !(keyboard_get_action_class(action) & ACTION_CLASS_RELATIVE);
+}
+
+static bool keymap_is_valid_step(const KEYBOARD_ACTION *action)
+{
+	return keymap_is_valid_action(action)
+		&& (keyboard_get_action_class(action) & (ACTION_CLASS_HELD | ACTION_CLASS_RELATIVE)) != 0;
+}
+
+static bool keymap_is_valid_accel(const struct ENCODER_ACCEL_POINT *point)
+{
+	return point->steps <= INT8_MAX;
+}
+
+static bool keymap_is_valid(const KEYMAP_IMAGE *image)
+{
+	if(image->version != KEYMAP_VERSION || image->crc != keymap_crc(image))
+	{
+		return false;
+	}
+	for(uint8_t i = 0; i < ENCODER_ACCEL_POINTS; i++)
+	{
+		if(!keymap_is_valid_accel(&image->accelCurve[i]))
+		{
+			return false;
+		}
+	}
+	for(uint8_t layer = 0; layer < KEYBOARD_LAYER_COUNT; layer++)
+	{
+		const KEYBOARD_LAYER *entry = &image->layers[layer];
+		
+		for(uint8_t btn = 0; btn < BUTTON_COUNT; btn++)
+		{
+			if(!keymap_is_valid_key(&entry->keys[btn].action) || !keymap_is_valid_key(&entry->keys[btn].alt))
+			{
+				return false;
+			}
+		}
+		if(!keymap_is_valid_step(&entry->encoderCw) || !keymap_is_valid_step(&entry->encoderCcw))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Length of the entry starting at 'offset' into the KEYMAP_IMAGE. The
+// header counts as one, macro bytes are not checked and go one by one.
+static uint8_t keymap_entry_length(uint16_t offset)
+{
+	if(offset < offsetof(KEYMAP_IMAGE, layers))
+	{
+		return offsetof(KEYMAP_IMAGE, layers);
+	}
+	if(offset < offsetof(KEYMAP_IMAGE, macros))
+	{
+		offset = (offset - offsetof(KEYMAP_IMAGE, layers)) % sizeof(KEYBOARD_LAYER);
+		return offset < offsetof(KEYBOARD_LAYER, encoderCw) ? sizeof(struct KEYBOARD_KEY) : sizeof(KEYBOARD_ACTION);
+	}
+	if(offset < offsetof(KEYMAP_IMAGE, accelCurve))
+	{
+		return 1;
+	}
+	return sizeof(struct ENCODER_ACCEL_POINT);
+}
+
+static bool keymap_is_valid_entry(uint16_t offset)
+{
+	const struct KEYBOARD_KEY *key = (const struct KEYBOARD_KEY *)_entry;
+	
+	if(offset < offsetof(KEYMAP_IMAGE, layers))
+	{
+		_incomingCrc = _entry[offsetof(KEYMAP_IMAGE, crc)] | _entry[offsetof(KEYMAP_IMAGE, crc) + 1] << 8;
+		return _entry[offsetof(KEYMAP_IMAGE, version)] == KEYMAP_VERSION;
+	}
+	if(offset < offsetof(KEYMAP_IMAGE, macros))
+	{
+		offset = (offset - offsetof(KEYMAP_IMAGE, layers)) % sizeof(KEYBOARD_LAYER);
+		if(offset < offsetof(KEYBOARD_LAYER, encoderCw))
+		{
+			return keymap_is_valid_key(&key->action) && keymap_is_valid_key(&key->alt);
+		}
+		return keymap_is_valid_step((const KEYBOARD_ACTION *)_entry);
+	}
+	if(offset < offsetof(KEYMAP_IMAGE, accelCurve))
+	{
+		return true;
+	}
+	return keymap_is_valid_accel((const struct ENCODER_ACCEL_POINT *)_entry);
+}
+
+void keymap_init(void)
+{
+	eeprom_read_block(&_keymap, &_eeKeymap, sizeof(_keymap));
+	if(!keymap_is_valid(&_keymap))
+	{
+		memcpy_P(_keymap.layers, keymapDefaults, sizeof(_keymap.layers));
+		memset(_keymap.macros, 0, sizeof(_keymap.macros));
+		memcpy_P(_keymap.macros, macroDefaults, sizeof(macroDefaults));
+		memcpy_P(_keymap.accelCurve, accelCurveDefaults, sizeof(_keymap.accelCurve));
+		_keymap.version = KEYMAP_VERSION;
+		_keymap.crc = keymap_crc(&_keymap);
+	}
+	rotaryEncoder_set_accel_curve(_keymap.accelCurve);
+}
+
+const struct KEYBOARD_KEY *keymap_get_key(uint8_t layer, uint8_t btn)
+{
+	return &_keymap.layers[layer].keys[btn];
+}
+
+const KEYBOARD_LAYER *keymap_get_layer(uint8_t layer)
+{
+	return &_keymap.layers[layer];
+}
+
+const uint8_t *keymap_get_macros(void)
+{
+	return _keymap.macros;
+}
+
+// Puts back the map in EEPROM over one received in part. The gestures and
+// layers the keyboard is in belong to the map they started in.
+static void keymap_restore(void)
+{
+	keymap_init();
+	keyboard_reset();
+	_receiving = false;
+}
+
+bool keymap_is_receiving(void)
+{
+	return _receiving;
+}
+
+void keymap_report_cancel(void)
+{
+	if(_receiving)
+	{
+		keymap_restore();
+	}
+}
+
+void keymap_report_begin(void)
+{
+	keymap_report_cancel();
+	_transferOffset = 0;
+	_entryFill = 0;
+	_crc = 0xFFFF;
+}
+
+uint8_t keymap_report_read(uint8_t *data, uint8_t len)
+{
+	uint8_t count = 0;
+	
+	for(; count < len && _transferOffset < KEYMAP_REPORT_LENGTH; count++, _transferOffset++)
+	{
+		data[count] = _transferOffset == 0 ? REPORT_ID_KEYMAP : ((const uint8_t *)&_keymap)[_transferOffset - 1];
+	}
+	return count;
+}
+
+uint8_t keymap_report_write(const uint8_t *data, uint8_t len)
+{
+	// A rejected map is replaced by the one in EEPROM, so that has to be
+	// complete before another one may overwrite entries. A macro reads
+	// its steps from the map as it plays, so it has to be done too.
+	if(_transferOffset == 0)
+	{
+		if(eepromWriter_get_pending() != 0 || macro_is_running())
+		{
+			return 0xFF;
+		}
+		_receiving = true;
+	}
+	for(uint8_t i = 0; i < len && _transferOffset < KEYMAP_REPORT_LENGTH; i++, _transferOffset++)
+	{
+		uint16_t offset;
+		
+		if(_transferOffset == 0)
+		{
+			continue;
+		}
+		offset = _transferOffset - 1 - _entryFill;
+		_entry[_entryFill++] = data[i];
+		if(offset >= offsetof(KEYMAP_IMAGE, layers))
+		{
+			_crc = _crc16_update(_crc, data[i]);
+		}
+		if(_entryFill < keymap_entry_length(offset))
+		{
+			continue;
+		}
+		
+		if(!keymap_is_valid_entry(offset))
+		{
+			keymap_restore();
+			return 0xFF;
+		}
+		if(offset >= offsetof(KEYMAP_IMAGE, layers))
+		{
+			memcpy((uint8_t *)&_keymap + offset, _entry, _entryFill);
+		}
+		_entryFill = 0;
+	}
+	if(_transferOffset < KEYMAP_REPORT_LENGTH)
+	{
+		return 0;
+	}
+	
+	if(_crc != _incomingCrc)
+	{
+		keymap_restore();
+		return 0xFF;
+	}
+	_keymap.version = KEYMAP_VERSION;
+	_keymap.crc = _crc;
+	_receiving = false;
+	keyboard_reset();
+	rotaryEncoder_set_accel_curve(_keymap.accelCurve);
+	eepromWriter_write(&_eeKeymap, &_keymap, sizeof(_keymap));
+	return 1;
+}
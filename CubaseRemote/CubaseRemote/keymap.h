@@ -0,0 +1,89 @@
+/*
+ * keymap.h
+ *
+ * Created: 17-Oct-26 5:10:27 PM
+ */ 
+
+
+#ifndef KEYMAP_H_
+#define KEYMAP_H_
+
+#include "globals.h"
+#include "keyboard.h"
+#include "macro.h"
+#include "rotaryEncoder.h"
+
+// Bump whenever the layout of KEYMAP_IMAGE changes; images of another
+// version are rejected and the defaults are used instead.
+#define KEYMAP_VERSION	2
+
+#define KEYMAP_MACRO_STEPS	24
+#define KEYMAP_MACRO_BYTES	(KEYMAP_MACRO_STEPS * MACRO_STEP_SIZE)
+
+// Only ON_PRESSED reports at the press edge; every other mode has to wait
+// for a release or a timeout to tell its gestures apart.
+enum KEYBOARD_MAP_MDOE
+{
+	ON_PRESSED = 1,		// action held while the button is down
+	ON_RELEASED,		// action tapped on release
+	LONG_PRESS,			// released before KEYBOARD_LONG_PRESS_SAMPLES: action tapped, else alt tapped
+	TAP_HOLD,			// released before KEYBOARD_HOLD_SAMPLES: action tapped, else alt held
+	DOUBLE_TAP,			// single tap: action tapped, second press within KEYBOARD_DOUBLE_TAP_SAMPLES: alt held
+};
+
+struct KEYBOARD_KEY {
+	uint8_t mode;				// KEYBOARD_MAP_MDOE, ignored for layer actions, they act on the edge
+	KEYBOARD_ACTION action;
+	KEYBOARD_ACTION alt;		// second gesture, unused for ON_PRESSED / ON_RELEASED
+};
+
+typedef struct
+{
+	struct KEYBOARD_KEY keys[BUTTON_COUNT];		// indexed by BUTTON
+	KEYBOARD_ACTION encoderCw;					// one step clockwise, ACTION_KEY, ACTION_CONSUMER or ACTION_WHEEL
+	KEYBOARD_ACTION encoderCcw;
+} KEYBOARD_LAYER;
+
+// Stored in EEPROM and carried by the REPORT_ID_KEYMAP feature report
+// right after the report ID, byte for byte, multi-byte fields little endian.
+// Packed so host tools share the layout, see CubaseRemote/host.
+typedef struct __attribute__((packed))
+{
+	uint8_t version;		// KEYMAP_VERSION
+	uint16_t crc;			// CRC-16 (0xA001, init 0xFFFF) over everything after it
+	KEYBOARD_LAYER layers[KEYBOARD_LAYER_COUNT];
+	uint8_t macros[KEYMAP_MACRO_BYTES];		// MACRO_STEP()s, see macro.h
+	struct ENCODER_ACCEL_POINT accelCurve[ENCODER_ACCEL_POINTS];
+} KEYMAP_IMAGE;
+
+// Loads the keymap from EEPROM, or the defaults if it holds no valid one.
+void keymap_init(void);
+
+// Lookups read the RAM copy only.
+const struct KEYBOARD_KEY *keymap_get_key(uint8_t layer, uint8_t btn);
+const KEYBOARD_LAYER *keymap_get_layer(uint8_t layer);
+const uint8_t *keymap_get_macros(void);
+
+// Feature report transfer, see usbFunctionRead() / usbFunctionWrite().
+// The stream starts with the report ID, followed by the KEYMAP_IMAGE.
+#define KEYMAP_REPORT_LENGTH	(1 + sizeof(KEYMAP_IMAGE))
+
+void keymap_report_begin(void);
+uint8_t keymap_report_read(uint8_t *data, uint8_t len);
+
+// Entries take effect as they arrive. Returns 0 while more data is
+// expected, 1 once a valid keymap has been taken over and 0xFF if it was
+// rejected: an entry failed its check, the CRC did not match, the last
+// map was still being saved or a macro still playing. A rejected map is
+// undone from EEPROM.
+uint8_t keymap_report_write(const uint8_t *data, uint8_t len);
+
+// Undoes a map the host stopped sending before its last byte, from EEPROM.
+// Call on every setup request; also done by keymap_report_begin().
+void keymap_report_cancel(void);
+
+// True while part of a new map is in place. Macros wait for the rest.
+bool keymap_is_receiving(void);
+
+
+#endif /* KEYMAP_H_ */
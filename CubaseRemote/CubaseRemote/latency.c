@@ -0,0 +1,66 @@
+/*
+ * latency.c
+ *
+ * Created: 17-Oct-26 9:22:08 PM
+ */
+
+#include <string.h>
+
+#include "latency.h"
+#include "reportScheduler.h"
+#include "timer2.h"
+
+static struct LATENCY_HISTOGRAM _histograms[LATENCY_SOURCE_COUNT];
+static uint8_t _transferOffset;		// bytes of the report read so far
+
+void latency_init(void)
+{
+	memset(_histograms, 0, sizeof(_histograms));
+}
+
+void latency_record(uint8_t source, uint16_t since)
+{
+	struct LATENCY_HISTOGRAM *h = &_histograms[source];
+	uint16_t samples = timer2_get_samples() - since;
+	uint8_t bucket = 0;
+
+	for(uint16_t v = samples; v != 0 && bucket < LATENCY_BUCKETS - 1; v >>= 1)
+	{
+		bucket++;
+	}
+	if(h->buckets[bucket] != UINT16_MAX)
+	{
+		h->buckets[bucket]++;
+	}
+	if(h->count != UINT16_MAX)
+	{
+		h->count++;
+		h->total += samples;
+	}
+	if(samples > h->max)
+	{
+		h->max = samples;
+	}
+}
+
+void latency_report_begin(void)
+{
+	_transferOffset = 0;
+}
+
+uint8_t latency_report_read(uint8_t *data, uint8_t len)
+{
+	uint8_t count = 0;
+	
+	for(; count < len && _transferOffset < LATENCY_REPORT_LENGTH; count++, _transferOffset++)
+	{
+		data[count] = _transferOffset == 0 ? REPORT_ID_LATENCY
+			: _transferOffset == 1 ? LATENCY_UNIT_US / 10
+			: ((const uint8_t *)_histograms)[_transferOffset - 2];
+	}
+	if(count != 0 && _transferOffset == LATENCY_REPORT_LENGTH)
+	{
+		latency_init();
+	}
+	return count;
+}
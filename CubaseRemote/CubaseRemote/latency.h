@@ -0,0 +1,57 @@
+/*
+ * latency.h
+ *
+ * Created: 17-Oct-26 9:20:31 PM
+ */
+
+
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include "globals.h"
+
+// Input to report latency, from the debounced button edge or the encoder
+// detent to the report that carries it being handed to usbSetInterrupt().
+// Measured in timer2 samples (250 us); host polling adds up to
+// USB_CFG_INTR_POLL_INTERVAL on top.
+
+#define LATENCY_UNIT_US		250
+
+// Bucket 0 counts 0 samples, bucket n 2^(n-1) up to 2^n - 1 samples, the
+// last one everything from 2^(LATENCY_BUCKETS-2) = 64 ms up.
+#define LATENCY_BUCKETS		10
+
+typedef enum _LATENCY_SOURCE
+{
+	LATENCY_BUTTON,
+	LATENCY_ENCODER,
+	LATENCY_SOURCE_COUNT
+} LATENCY_SOURCE;
+
+// Counters stop at their maximum; total stops with count, so total / count
+// stays the mean. Packed so host tools share the layout.
+struct __attribute__((packed)) LATENCY_HISTOGRAM
+{
+	uint16_t buckets[LATENCY_BUCKETS];
+	uint16_t count;
+	uint16_t max;			// samples
+	uint32_t total;			// samples
+};
+
+// REPORT_ID_LATENCY feature report: report ID, LATENCY_UNIT_US / 10, then
+// one histogram per LATENCY_SOURCE, multi-byte fields little endian.
+#define LATENCY_REPORT_LENGTH	(2 + LATENCY_SOURCE_COUNT * sizeof(struct LATENCY_HISTOGRAM))
+
+void latency_init(void);
+
+// Main loop only. 'since' is a timer2_get_samples() time.
+void latency_record(uint8_t source, uint16_t since);
+
+// Feature report transfer, see usbFunctionRead(). The histograms are read
+// in place and start over once the last byte is out; a sample recorded
+// during the few ms of the transfer may be left out of the report.
+void latency_report_begin(void);
+uint8_t latency_report_read(uint8_t *data, uint8_t len);
+
+
+#endif /* LATENCY_H_ */
@@ -0,0 +1,110 @@
+/*
+ * macro.c
+ *
+ * Plays key sequences from the keymap, one keyboard report per free
+ * interrupt-IN slot. Every step is pressed, released on the next slot and
+ * followed by its delay, measured on the timer2 tick, so nothing here ever
+ * waits inside the main loop.
+ *
+ * Created: 17-Oct-26 4:03:40 PM
+ */ 
+
+#include "macro.h"
+#include "keymap.h"
+#include "timer2.h"
+#include "USB/usb_hid_keys.h"
+
+enum MACRO_PHASE
+{
+	MACRO_IDLE,
+	MACRO_PRESS,
+	MACRO_RELEASE,
+	MACRO_WAIT,
+};
+
+static uint8_t _phase;
+static uint16_t _offset;
+static uint16_t _waitStart;
+static uint8_t _waitTicks;
+
+void macro_init(void)
+{
+	_phase = MACRO_IDLE;
+}
+
+void macro_start(uint8_t id)
+{
+	const uint8_t *macroData = keymap_get_macros();
+	uint16_t offset = 0;
+	
+	if(_phase != MACRO_IDLE)
+	{
+		return;
+	}
+	
+	// Skip 'id' macros to find the start of this one.
+	while(id != 0 && offset < KEYMAP_MACRO_BYTES)
+	{
+		if(macroData[offset] == 0 && macroData[offset + 1] == KEY_NONE)
+		{
+			id--;
+		}
+		offset += MACRO_STEP_SIZE;
+	}
+	
+	if(offset < KEYMAP_MACRO_BYTES)
+	{
+		_offset = offset;
+		_phase = MACRO_PRESS;
+	}
+}
+
+bool macro_is_running(void)
+{
+	return _phase != MACRO_IDLE;
+}
+
+bool macro_poll(uint8_t *modifiers, uint8_t *hidCode)
+{
+	const uint8_t *macroData = keymap_get_macros();
+	
+	switch(_phase)
+	{
+		case MACRO_PRESS:
+			// A macro running off the end of the area stops there.
+			if(_offset >= KEYMAP_MACRO_BYTES)
+			{
+				_phase = MACRO_IDLE;
+				return false;
+			}
+			*modifiers = macroData[_offset];
+			*hidCode = macroData[_offset + 1];
+			if(*modifiers == 0 && *hidCode == KEY_NONE)
+			{
+				_phase = MACRO_IDLE;
+				return false;
+			}
+			_phase = MACRO_RELEASE;
+			return true;
+		
+		case MACRO_RELEASE:
+			*modifiers = 0;
+			*hidCode = KEY_NONE;
+			_waitTicks = macroData[_offset + 2] / TIMER2_TICK_MS;
+			_waitStart = timer2_get_ticks();
+			_offset += MACRO_STEP_SIZE;
+			_phase = MACRO_WAIT;
+			return true;
+		
+		case MACRO_WAIT:
+			if((uint16_t)(timer2_get_ticks() - _waitStart) >= _waitTicks)
+			{
+				_phase = MACRO_PRESS;
+				return macro_poll(modifiers, hidCode);
+			}
+			return false;
+		
+		default:
+			return false;
+	}
+}
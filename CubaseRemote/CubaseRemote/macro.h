@@ -0,0 +1,36 @@
+/*
+ * macro.h
+ *
+ * Created: 17-Oct-26 4:02:13 PM
+ */ 
+
+
+#ifndef MACRO_H_
+#define MACRO_H_
+
+#include "globals.h"
+
+// Macro ids, in the order they appear in macroDefaults[] in keymap.c.
+#define MACRO_SELECT_SOLO_PLAY	0
+
+// Macros are kept back to back in the keymap, each ended by MACRO_END.
+// One step: modifiers, key, delay in ms after the key is released.
+#define MACRO_STEP(modifiers, key, delay)	(modifiers), (key), (delay)
+#define MACRO_END							0, 0, 0
+
+#define MACRO_STEP_SIZE 3
+
+void macro_init(void);
+
+// Starts playing a macro. Ignored while another one is still playing, so
+// the caller keeps a macro key waiting until macro_is_running() is false.
+void macro_start(uint8_t id);
+
+bool macro_is_running(void);
+
+// Call when the keyboard interrupt-IN endpoint is free. Returns true with the
+// keyboard report content if the macro has a report due now.
+bool macro_poll(uint8_t *modifiers, uint8_t *hidCode);
+
+
+#endif /* MACRO_H_ */
\ No newline at end of file
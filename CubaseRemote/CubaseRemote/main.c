@@ -16,53 +16,26 @@
 
 #include "timer2.h"
 #include "rotaryEncoder.h"
+#include "eepromWriter.h"
 
 #include "keyboard.h"
+#include "keymap.h"
+#include "reportScheduler.h"
+#include "profiler.h"
+#include "latency.h"
 
-#include "USB/usb_hid_keys.h"
 #include "USB/usb_hid_consumer.h"
 
 
-typedef struct
-{
-	uint8_t  reportId;                                 // Report ID = 0x01 (1)
-	// Collection: CA:ConsumerControl
-	uint16_t ConsumerControl;                          // Value = 0 to 572
-} inputConsumer_t;
-	
 static uint8_t idleRate;           /* in 4 ms units */
+static uint8_t readReportId;       /* of the GET_REPORT usbFunctionRead() answers */
+static uint8_t writeReportId;      /* of the SET_REPORT usbFunctionWrite() receives */
 
-typedef struct
-{
-	uint8_t  reportId;                                 // Report ID = 0x02 (2)
-	// Collection: CA:Keyboard
-	uint8_t  KB_KeyboardKeyboardLeftControl  : 1;       // Usage 0x000700E0: Keyboard Left Control, Value = 0 to 1
-	uint8_t  KB_KeyboardKeyboardLeftShift	 : 1;         // Usage 0x000700E1: Keyboard Left Shift, Value = 0 to 1
-	uint8_t  KB_KeyboardKeyboardLeftAlt		 : 1;           // Usage 0x000700E2: Keyboard Left Alt, Value = 0 to 1
-	uint8_t  KB_KeyboardKeyboardLeftGui		 : 1;           // Usage 0x000700E3: Keyboard Left GUI, Value = 0 to 1
-	uint8_t  KB_KeyboardKeyboardRightControl : 1;      // Usage 0x000700E4: Keyboard Right Control, Value = 0 to 1
-	uint8_t  KB_KeyboardKeyboardRightShift	 : 1;        // Usage 0x000700E5: Keyboard Right Shift, Value = 0 to 1
-	uint8_t  KB_KeyboardKeyboardRightAlt	 : 1;          // Usage 0x000700E6: Keyboard Right Alt, Value = 0 to 1
-	uint8_t  KB_KeyboardKeyboardRightGui	 : 1;          // Usage 0x000700E7: Keyboard Right GUI, Value = 0 to 1
-	uint8_t  Keyboard;                                 // Value = 0 to 101
-} inputKeyboard_t;
-
-static inputConsumer_t consumer_Report;
-static inputKeyboard_t keyboard_report; // sent to PC
+/* Offset of an interface's HID descriptor in usbDescriptorConfiguration */
+#define HID_DESCRIPTOR_OFFSET(interface)	(9 + 9 + (interface) * (9 + 9 + 7))
 
+/* Layout must match the report structs in reportScheduler.c */
 PROGMEM const char usbHidReportDescriptor[USB_CFG_HID_REPORT_DESCRIPTOR_LENGTH] = { /* USB report descriptor */
-	0x05, 0x0c,                    // USAGE_PAGE (Consumer Devices)
-	0x09, 0x01,                    // USAGE (Consumer Control)
-	0xa1, 0x01,                    // COLLECTION (Application)
-	0x85, 0x01,                    //   REPORT_ID (1)
-	0x19, 0x00,                    //   USAGE_MINIMUM (Unassigned)
-	0x2a, 0x3c, 0x02,              //   USAGE_MAXIMUM (AC Format)
-	0x15, 0x00,                    //   LOGICAL_MINIMUM (0)
-	0x26, 0x3c, 0x02,              //   LOGICAL_MAXIMUM (572)
-	0x95, 0x01,                    //   REPORT_COUNT (1)
-	0x75, 0x10,                    //   REPORT_SIZE (16)
-	0x81, 0x00,                    //   INPUT (Data,Var,Abs)
-	0xc0,                          // END_COLLECTION
 	0x05, 0x01,                    // USAGE_PAGE (Generic Desktop)
 	0x09, 0x06,                    // USAGE (Keyboard)
 	0xa1, 0x01,                    // COLLECTION (Application)
@@ -75,67 +48,247 @@ PROGMEM const char usbHidReportDescriptor[USB_CFG_HID_REPORT_DESCRIPTOR_LENGTH]
 	0x75, 0x01,                    //   REPORT_SIZE (1)
 	0x95, 0x08,                    //   REPORT_COUNT (8)
 	0x81, 0x02,                    //   INPUT (Data,Var,Abs)
-	0x95, 0x01,                    //   REPORT_COUNT (1)
+	0x95, 0x06,                    //   REPORT_COUNT (6)
 	0x75, 0x08,                    //   REPORT_SIZE (8)
-	0x25, 0x65,                    //   LOGICAL_MAXIMUM (101)
+	0x26, 0xff, 0x00,              //   LOGICAL_MAXIMUM (255)
 	0x19, 0x00,                    //   USAGE_MINIMUM (Reserved (no event indicated))
-	0x29, 0x65,                    //   USAGE_MAXIMUM (Keyboard Application)
+	0x29, 0xff,                    //   USAGE_MAXIMUM (255), every key code a keymap can hold
 	0x81, 0x00,                    //   INPUT (Data,Ary,Abs)
+	0xc0,                          // END_COLLECTION
+	0x06, 0x00, 0xff,              // USAGE_PAGE (Vendor Defined Page 1)
+	0x09, 0x01,                    // USAGE (Vendor Usage 1)
+	0xa1, 0x01,                    // COLLECTION (Application)
+	0x85, REPORT_ID_KEYMAP,        //   REPORT_ID (3)
+	0x15, 0x00,                    //   LOGICAL_MINIMUM (0)
+	0x26, 0xff, 0x00,              //   LOGICAL_MAXIMUM (255)
+	0x75, 0x08,                    //   REPORT_SIZE (8)
+	0x95, sizeof(KEYMAP_IMAGE),    //   REPORT_COUNT (keymap image)
+	0x09, 0x00,                    //   USAGE (Undefined)
+	0xb2, 0x02, 0x01,              //   FEATURE (Data,Var,Abs,Buf)
+	0x85, REPORT_ID_LATENCY,       //   REPORT_ID (5)
+	0x95, LATENCY_REPORT_LENGTH - 1, //   REPORT_COUNT (latency histograms)
+	0x09, 0x00,                    //   USAGE (Undefined)
+	0xb2, 0x02, 0x01,              //   FEATURE (Data,Var,Abs,Buf)
+#ifdef PROFILER
+	0x85, REPORT_ID_PROFILE,       //   REPORT_ID (4)
+	0x95, PROFILE_REPORT_LENGTH - 1, //   REPORT_COUNT (stage statistics)
+	0x09, 0x00,                    //   USAGE (Undefined)
+	0xb2, 0x02, 0x01,              //   FEATURE (Data,Var,Abs,Buf)
+#endif
 	0xc0                           // END_COLLECTION
 
 };
 
+PROGMEM const char usbHidReportDescriptorConsumer[] = {
+	0x05, 0x0c,                    // USAGE_PAGE (Consumer Devices)
+	0x09, 0x01,                    // USAGE (Consumer Control)
+	0xa1, 0x01,                    // COLLECTION (Application)
+	0x85, 0x01,                    //   REPORT_ID (1)
+	0x19, 0x00,                    //   USAGE_MINIMUM (Unassigned)
+	0x2a, (uint8_t)HID_CONSUMER_USAGE_MAX, HID_CONSUMER_USAGE_MAX >> 8, //   USAGE_MAXIMUM (AC Distribute Vertically)
+	0x15, 0x00,                    //   LOGICAL_MINIMUM (0)
+	0x26, (uint8_t)HID_CONSUMER_USAGE_MAX, HID_CONSUMER_USAGE_MAX >> 8, //   LOGICAL_MAXIMUM (668)
+	0x95, CONSUMER_ROLLOVER,       //   REPORT_COUNT (3)
+	0x75, 0x10,                    //   REPORT_SIZE (16)
+	0x81, 0x00,                    //   INPUT (Data,Ary,Abs)
+	0xc0,                          // END_COLLECTION
+	// The multipliers share a logical collection with their axis, so the
+	// host knows which one scales which (HUT 1.12, Resolution Multiplier).
+	0x05, 0x01,                    // USAGE_PAGE (Generic Desktop)
+	0x09, 0x02,                    // USAGE (Mouse)
+	0xa1, 0x01,                    // COLLECTION (Application)
+	0x85, REPORT_ID_MOUSE,         //   REPORT_ID (6)
+	0x09, 0x01,                    //   USAGE (Pointer)
+	0xa1, 0x00,                    //   COLLECTION (Physical)
+	0x09, 0x30,                    //     USAGE (X)
+	0x09, 0x31,                    //     USAGE (Y)
+	0x15, 0x81,                    //     LOGICAL_MINIMUM (-127)
+	0x25, 0x7f,                    //     LOGICAL_MAXIMUM (127)
+	0x75, 0x08,                    //     REPORT_SIZE (8)
+	0x95, 0x02,                    //     REPORT_COUNT (2)
+	0x81, 0x06,                    //     INPUT (Data,Var,Rel)
+	0xa1, 0x02,                    //     COLLECTION (Logical)
+	0x09, 0x48,                    //       USAGE (Resolution Multiplier)
+	0x15, 0x00,                    //       LOGICAL_MINIMUM (0)
+	0x25, 0x01,                    //       LOGICAL_MAXIMUM (1)
+	0x35, 0x01,                    //       PHYSICAL_MINIMUM (1)
+	0x45, MOUSE_WHEEL_MULTIPLIER,  //       PHYSICAL_MAXIMUM (4)
+	0x75, 0x02,                    //       REPORT_SIZE (2)
+	0x95, 0x01,                    //       REPORT_COUNT (1)
+	0xb1, 0x02,                    //       FEATURE (Data,Var,Abs)
+	0x09, 0x38,                    //       USAGE (Wheel)
+	0x15, 0x81,                    //       LOGICAL_MINIMUM (-127)
+	0x25, 0x7f,                    //       LOGICAL_MAXIMUM (127)
+	0x35, 0x00,                    //       PHYSICAL_MINIMUM (0)
+	0x45, 0x00,                    //       PHYSICAL_MAXIMUM (0)
+	0x75, 0x08,                    //       REPORT_SIZE (8)
+	0x81, 0x06,                    //       INPUT (Data,Var,Rel)
+	0xc0,                          //     END_COLLECTION
+	0xa1, 0x02,                    //     COLLECTION (Logical)
+	0x09, 0x48,                    //       USAGE (Resolution Multiplier)
+	0x15, 0x00,                    //       LOGICAL_MINIMUM (0)
+	0x25, 0x01,                    //       LOGICAL_MAXIMUM (1)
+	0x35, 0x01,                    //       PHYSICAL_MINIMUM (1)
+	0x45, MOUSE_WHEEL_MULTIPLIER,  //       PHYSICAL_MAXIMUM (4)
+	0x75, 0x02,                    //       REPORT_SIZE (2)
+	0xb1, 0x02,                    //       FEATURE (Data,Var,Abs)
+	0x05, 0x0c,                    //       USAGE_PAGE (Consumer Devices)
+	0x0a, 0x38, 0x02,              //       USAGE (AC Pan)
+	0x15, 0x81,                    //       LOGICAL_MINIMUM (-127)
+	0x25, 0x7f,                    //       LOGICAL_MAXIMUM (127)
+	0x35, 0x00,                    //       PHYSICAL_MINIMUM (0)
+	0x45, 0x00,                    //       PHYSICAL_MAXIMUM (0)
+	0x75, 0x08,                    //       REPORT_SIZE (8)
+	0x81, 0x06,                    //       INPUT (Data,Var,Rel)
+	0xc0,                          //     END_COLLECTION
+	0x75, 0x04,                    //     REPORT_SIZE (4)
+	0xb1, 0x03,                    //     FEATURE (Cnst,Var,Abs)
+	0xc0,                          //   END_COLLECTION
+	0xc0                           // END_COLLECTION
+};
+
+/* Keyboard and consumer reports each get an interface and an interrupt-IN
+ * endpoint of their own, so a volume step does not have to wait for a
+ * shortcut to go out or the other way round. Hosts send class requests
+ * without an interface to interface 0, so the feature reports live there;
+ * only the wheel's resolution multipliers sit with the mouse on interface 1. */
+PROGMEM const char usbDescriptorConfiguration[USB_PROP_LENGTH(USB_CFG_DESCR_PROPS_CONFIGURATION)] = {
+	9,                             // sizeof(usbDescriptorConfiguration)
+	USBDESCR_CONFIG,
+	USB_PROP_LENGTH(USB_CFG_DESCR_PROPS_CONFIGURATION), 0, // total length
+	2,                             // number of interfaces
+	1,                             // index of this configuration
+	0,                             // configuration name string index
+	(1 << 7),                      // attributes: bus powered
+	USB_CFG_MAX_BUS_POWER / 2,     // in 2 mA units
 
-// Now only supports letters 'a' to 'z' and 0 (NULL) to clear buttons
-void buildKeyboardReport(uint8_t send_key) {
-	
-	keyboard_report.reportId = 2;
-	keyboard_report.KB_KeyboardKeyboardLeftControl	   = 0 ;
-	keyboard_report.KB_KeyboardKeyboardLeftShift	   = 0 ;
-	keyboard_report.KB_KeyboardKeyboardLeftAlt		   = 0 ;
-	keyboard_report.KB_KeyboardKeyboardLeftGui		   = 0 ;
-	keyboard_report.KB_KeyboardKeyboardRightControl	   = 0 ;
-	keyboard_report.KB_KeyboardKeyboardRightShift	   = 0 ;
-	keyboard_report.KB_KeyboardKeyboardRightAlt		   = 0 ;
-	keyboard_report.KB_KeyboardKeyboardRightGui		   = 0 ;
-	keyboard_report.Keyboard = send_key;
-	
-}
+	9,                             // sizeof(usbDescrInterface)
+	USBDESCR_INTERFACE,
+	INTERFACE_KEYBOARD,
+	0,                             // alternate setting
+	1,                             // endpoints excl 0
+	USB_CFG_INTERFACE_CLASS,
+	USB_CFG_INTERFACE_SUBCLASS,
+	USB_CFG_INTERFACE_PROTOCOL,
+	0,                             // string index for interface
+	9,                             // sizeof(usbDescrHID)
+	USBDESCR_HID,
+	0x01, 0x01,                    // HID version 1.01
+	0x00,                          // target country code
+	0x01,                          // number of report descriptors
+	USBDESCR_HID_REPORT,
+	sizeof(usbHidReportDescriptor), 0,
+	7,                             // sizeof(usbDescrEndpoint)
+	USBDESCR_ENDPOINT,
+	(char)0x81,                    // IN endpoint 1
+	0x03,                          // interrupt
+	8, 0,                          // maximum packet size
+	USB_CFG_INTR_POLL_INTERVAL,
+
+	9,                             // sizeof(usbDescrInterface)
+	USBDESCR_INTERFACE,
+	INTERFACE_CONSUMER,
+	0,                             // alternate setting
+	1,                             // endpoints excl 0
+	USB_CFG_INTERFACE_CLASS,
+	USB_CFG_INTERFACE_SUBCLASS,
+	USB_CFG_INTERFACE_PROTOCOL,
+	0,                             // string index for interface
+	9,                             // sizeof(usbDescrHID)
+	USBDESCR_HID,
+	0x01, 0x01,                    // HID version 1.01
+	0x00,                          // target country code
+	0x01,                          // number of report descriptors
+	USBDESCR_HID_REPORT,
+	sizeof(usbHidReportDescriptorConsumer), 0,
+	7,                             // sizeof(usbDescrEndpoint)
+	USBDESCR_ENDPOINT,
+	(char)(0x80 | USB_CFG_EP3_NUMBER), // IN endpoint 3
+	0x03,                          // interrupt
+	8, 0,                          // maximum packet size
+	USB_CFG_INTR_POLL_INTERVAL
+};
 
-void buildConsumerReport(uint8_t key)
-{
-	consumer_Report.reportId = 1;
-	consumer_Report.ConsumerControl = key;
-}
 
 /* ------------------------------------------------------------------------- */
 
+/* HID and report descriptors, by the interface in wIndex */
+usbMsgLen_t usbFunctionDescriptor(struct usbRequest *rq)
+{
+	uint8_t interface = rq->wIndex.bytes[0];
+	
+	if (interface > INTERFACE_CONSUMER)
+	{
+		return 0;
+	}
+	if (rq->wValue.bytes[1] == USBDESCR_HID)
+	{
+		usbMsgPtr = (usbMsgPtr_t)(usbDescriptorConfiguration + HID_DESCRIPTOR_OFFSET(interface));
+		return 9;
+	}
+	if (rq->wValue.bytes[1] == USBDESCR_HID_REPORT)
+	{
+		if (interface == INTERFACE_CONSUMER)
+		{
+			usbMsgPtr = (usbMsgPtr_t)usbHidReportDescriptorConsumer;
+			return sizeof(usbHidReportDescriptorConsumer);
+		}
+		usbMsgPtr = (usbMsgPtr_t)usbHidReportDescriptor;
+		return sizeof(usbHidReportDescriptor);
+	}
+	return 0;
+}
+
 usbMsgLen_t usbFunctionSetup(uint8_t data[8])
 {
 	usbRequest_t    *rq = (void *)data;
 
+	/* a new request ends any keymap SET_REPORT or profile read the host
+	 * gave up on */
+	keymap_report_cancel();
+	profiler_report_cancel();
 	if((rq->bmRequestType & USBRQ_TYPE_MASK) == USBRQ_TYPE_CLASS)
 	{    /* class request type */
 		if(rq->bRequest == USBRQ_HID_GET_REPORT)
 		{  /* wValue: ReportType (highbyte), ReportID (lowbyte) */
-			/* we only have one report type, so don't look at wValue */
 			DBG1(0x21,rq,8);
-			if (rq->wValue.bytes[0] == 1)
+			readReportId = rq->wValue.bytes[0];
+			if (readReportId == REPORT_ID_KEYMAP)
 			{
-				buildConsumerReport(KEY_NONE);
-				usbMsgPtr = (usbMsgPtr_t)&consumer_Report;
-				return sizeof(consumer_Report);
+				keymap_report_begin();
+				return USB_NO_MSG;	/* answered by usbFunctionRead() */
 			}
-			
-			if(rq->wValue.bytes[0] == 2)
+			if (readReportId == REPORT_ID_LATENCY)
 			{
-				buildKeyboardReport(KEY_NONE);					   
-				usbMsgPtr = (usbMsgPtr_t)&keyboard_report;
-				return sizeof(keyboard_report);
+				latency_report_begin();
+				return USB_NO_MSG;
+			}
+			if (readReportId == REPORT_ID_MOUSE)
+			{
+				// The feature; the relative input has nothing to read back.
+				uint8_t *resolution;
+				usbMsgLen_t length = reportScheduler_get_resolution(&resolution);
+				usbMsgPtr = (usbMsgPtr_t)resolution;
+				return length;
+			}
+#ifdef PROFILER
+			if (readReportId == REPORT_ID_PROFILE)
+			{
+				profiler_report_begin();
+				return USB_NO_MSG;
+			}
+#endif
+			uint8_t *report;
+			uint8_t length = reportScheduler_get_report(readReportId, &report);
+			if (length)
+			{
+				usbMsgPtr = (usbMsgPtr_t)report;
+				return length;
 			}
 		}
 		else if(rq->bRequest == USBRQ_HID_GET_IDLE)
 		{
+			idleRate = reportScheduler_get_idle(rq->wIndex.bytes[0], rq->wValue.bytes[0]);
 			usbMsgPtr = (usbMsgPtr_t)&idleRate;
 						
 			DBG1(0x22,rq,8);
@@ -143,7 +296,21 @@ usbMsgLen_t usbFunctionSetup(uint8_t data[8])
 
 		}else if(rq->bRequest == USBRQ_HID_SET_IDLE){
 			DBG1(0x23,rq,8);
-			idleRate = rq->wValue.bytes[1];
+			/* wValue: duration (highbyte), ReportID (lowbyte), wIndex: interface */
+			reportScheduler_set_idle(rq->wIndex.bytes[0], rq->wValue.bytes[0], rq->wValue.bytes[1]);
+			
+		}else if(rq->bRequest == USBRQ_HID_SET_REPORT){
+			DBG1(0x26,rq,8);
+			writeReportId = rq->wValue.bytes[0];
+			if (writeReportId == REPORT_ID_KEYMAP)
+			{
+				keymap_report_begin();
+				return USB_NO_MSG;	/* received by usbFunctionWrite() */
+			}
+			if (writeReportId == REPORT_ID_MOUSE)
+			{
+				return USB_NO_MSG;
+			}
 			
 		}else if(rq->bRequest == USBRQ_HID_GET_PROTOCOL){
 			DBG1(0x24,rq,8);
@@ -158,12 +325,42 @@ usbMsgLen_t usbFunctionSetup(uint8_t data[8])
 	return 0;
 }
 
+/* The keymap, latency and profile feature reports are streamed from where
+ * they are kept, see usbFunctionSetup() */
+uchar usbFunctionRead(uchar *data, uchar len)
+{
+	if (readReportId == REPORT_ID_LATENCY)
+	{
+		return latency_report_read(data, len);
+	}
+#ifdef PROFILER
+	if (readReportId == REPORT_ID_PROFILE)
+	{
+		return profiler_report_read(data, len);
+	}
+#endif
+	return keymap_report_read(data, len);
+}
+
+/* The resolution multipliers fit in one data packet */
+uchar usbFunctionWrite(uchar *data, uchar len)
+{
+	if (writeReportId == REPORT_ID_MOUSE)
+	{
+		reportScheduler_set_resolution(data, len);
+		return 1;
+	}
+	return keymap_report_write(data, len);
+}
+
 
 
 int main(void)
 {
 	odDebugInit();
 	usbInit();
+	profiler_init();
+	eepromWriter_init();
 	keyboard_init();
 	usbDeviceDisconnect();
 	{
@@ -178,71 +375,15 @@ int main(void)
 	timer2_init();
 	sei();
 	
-	bool mustCloseConsumer = false;
-	//bool mustCloseKeyboard = false;
+	reportScheduler_init();
     while (1) 
     {
-		usbPoll();   
-		keyboard_routine();
-		
-		if( usbInterruptIsReady()){
-			ENCODER_SPIN_DIRECTION encoderDirection = rotaryEncoder_get_direction();
-			
-			switch(encoderDirection)
-			{
-				case ENCODER_SPIN_DIRECTION_LEFT:
-				{
-					buildConsumerReport(HID_CONSUMER_VOLUME_UP);
-					mustCloseConsumer = true;
-					usbSetInterrupt((void *)&consumer_Report, sizeof(consumer_Report));
-				}
-				break;
-				case ENCODER_SPIN_DIRECTION_RIGHT:
-				{
-					buildConsumerReport(HID_CONSUMER_VOLUME_DOWN);
-					mustCloseConsumer = true;
-					usbSetInterrupt((void *)&consumer_Report, sizeof(consumer_Report));	
-				}
-				break;
-				case ENCODER_SPIN_DIRECTION_NONE:
-					if (mustCloseConsumer)
-					{
-						buildConsumerReport(KEY_NONE);
-						mustCloseConsumer = false;
-						usbSetInterrupt((void *)&consumer_Report, sizeof(consumer_Report));
-						continue;
-					}
-				default:
-				break;
-			}
-			
-			if(encoderDirection == ENCODER_SPIN_DIRECTION_NONE && !mustCloseConsumer)
-			{
-				uint8_t key = keyboard_get_pressed_key();
-				if(key)
-				{
-					if(key == HID_CONSUMER_MUTE)
-					{						
-						buildConsumerReport(HID_CONSUMER_MUTE);
-						mustCloseConsumer = true;
-						usbSetInterrupt((void *)&consumer_Report, sizeof(consumer_Report));
-					}
-					else
-					{
-						buildKeyboardReport(key); // fill keyboard_report with 'x' pressed
-						//mustCloseKeyboard = true;
-						usbSetInterrupt((void *)&keyboard_report, sizeof(keyboard_report));
-					}
-				}
-				else
-				{
-					buildKeyboardReport(KEY_NONE); // fill keyboard_report with 'x' pressed
-					//mustCloseKeyboard = false;
-					usbSetInterrupt((void *)&keyboard_report, sizeof(keyboard_report));
-				}
-			}
-			
-		}
+		PROFILE(PROFILE_LOOP,
+		{
+			PROFILE(PROFILE_USB_POLL, usbPoll());
+			keyboard_routine();
+			PROFILE(PROFILE_REPORTS, reportScheduler_poll());
+			PROFILE(PROFILE_EEPROM, eepromWriter_routine());
+		});
     }
 }
-
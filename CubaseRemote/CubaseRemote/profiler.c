@@ -0,0 +1,107 @@
+/*
+ * profiler.c
+ *
+ * Created: 17-Oct-26 8:43:52 PM
+ */
+
+#include <string.h>
+#include <util/atomic.h>
+
+#include "profiler.h"
+#include "reportScheduler.h"
+
+#ifdef PROFILER
+
+// The REPORT_ID_PROFILE feature report, kept as it is sent.
+static struct __attribute__((packed))
+{
+	uint8_t reportId;
+	struct PROFILE_STATS stats[PROFILE_STAGE_COUNT];
+} _report;
+static uint8_t _transferOffset;		// bytes of the report read so far
+static bool _paused;				// a transfer is reading the report
+
+static void profiler_clear(void)
+{
+	memset(_report.stats, 0, sizeof(_report.stats));
+	for(uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++)
+	{
+		_report.stats[i].min = UINT16_MAX;
+	}
+}
+
+void profiler_init(void)
+{
+	_report.reportId = REPORT_ID_PROFILE;
+	profiler_clear();
+	TCCR1A = 0;
+	TCCR1B = ( 1 << CS10 );	// free running, no prescaler
+}
+
+void profiler_record(uint8_t stage, uint16_t start)
+{
+	uint16_t cycles = TCNT1 - start;
+	struct PROFILE_STATS *s = &_report.stats[stage];
+
+	// Main loop stages are recorded with the timer2 interrupt enabled.
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if(_paused)
+		{
+			return;
+		}
+		if(s->count == UINT16_MAX)
+		{
+			s->count /= 2;
+			s->total /= 2;
+		}
+		s->count++;
+		s->total += cycles;
+		if(cycles < s->min)
+		{
+			s->min = cycles;
+		}
+		if(cycles > s->max)
+		{
+			s->max = cycles;
+		}
+	}
+}
+
+void profiler_report_cancel(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		_paused = false;
+	}
+}
+
+void profiler_report_begin(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		_paused = true;
+	}
+	_transferOffset = 0;
+}
+
+uint8_t profiler_report_read(uint8_t *data, uint8_t len)
+{
+	uint8_t count = 0;
+	
+	for(; count < len && _transferOffset < PROFILE_REPORT_LENGTH; count++, _transferOffset++)
+	{
+		data[count] = ((const uint8_t *)&_report)[_transferOffset];
+	}
+	if(count != 0 && _transferOffset == PROFILE_REPORT_LENGTH)
+	{
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			profiler_clear();
+			_paused = false;
+		}
+	}
+	return count;
+}
+
+#endif
\ No newline at end of file
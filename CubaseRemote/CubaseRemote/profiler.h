@@ -0,0 +1,79 @@
+/*
+ * profiler.h
+ *
+ * Created: 17-Oct-26 8:41:19 PM
+ */
+
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <avr/io.h>
+
+#include "globals.h"
+
+// Instrumentation build only: compile everything with -DPROFILER to time
+// the main loop stages and the timer2 interrupt with timer1, running free
+// at F_CPU. Results are read, and cleared, with the REPORT_ID_PROFILE
+// feature report. Stages longer than 65535 cycles (4 ms) are not timed
+// correctly.
+//
+// The V-USB interrupt cannot be timed this way: it has to sync to the bus
+// within a few cycles of INT0, so it cannot be wrapped. Its cost shows up
+// in the max of whatever it interrupted.
+
+typedef enum _PROFILE_STAGE
+{
+	PROFILE_LOOP,			// one whole main loop pass
+	PROFILE_USB_POLL,
+	PROFILE_ENCODER_EVENTS,	// keyboard_routine(): encoder steps to the queue
+	PROFILE_BUTTON_EVENTS,	// keyboard_routine(): button gestures to the queue
+	PROFILE_REPORTS,		// reportScheduler_poll()
+	PROFILE_EEPROM,
+	PROFILE_TIMER2_ISR,		// whole interrupt, nested encoder and button work included
+	PROFILE_ENCODER_SAMPLE,	// rotaryEncoder_process()
+	PROFILE_BUTTON_SCAN,	// button_routine()
+	PROFILE_STAGE_COUNT
+} PROFILE_STAGE;
+
+// One per stage in the feature report, little endian, packed so host
+// tools share the layout.
+struct __attribute__((packed)) PROFILE_STATS
+{
+	uint16_t count;			// halved together with total before it overflows
+	uint16_t min;			// cycles
+	uint16_t max;
+	uint32_t total;
+};
+
+#define PROFILE_REPORT_LENGTH	(1 + PROFILE_STAGE_COUNT * sizeof(struct PROFILE_STATS))
+
+#ifdef PROFILER
+
+// Times 'call' as 'stage'.
+#define PROFILE(stage, call)	do { uint16_t _profileStart = TCNT1; call; profiler_record(stage, _profileStart); } while(0)
+
+void profiler_init(void);
+void profiler_record(uint8_t stage, uint16_t start);
+
+// Feature report transfer, see usbFunctionRead(). The report is read in
+// place; recording pauses from the request until its last byte is out,
+// then the statistics start over.
+void profiler_report_begin(void);
+uint8_t profiler_report_read(uint8_t *data, uint8_t len);
+
+// Resumes recording after a read that ended early, as a shorter wLength
+// or an aborted transfer does, keeping the statistics. Call on every
+// setup request.
+void profiler_report_cancel(void);
+
+#else
+
+#define PROFILE(stage, call)	call
+#define profiler_init()
+#define profiler_report_cancel()
+
+#endif
+
+
+#endif /* PROFILER_H_ */
\ No newline at end of file
@@ -0,0 +1,739 @@
+/*
+ * reportScheduler.c
+ *
+ * Turns queued input events into interrupt-IN reports. Key events update
+ * the set of held keys, which the keyboard and consumer reports mirror.
+ * The keyboard report goes out on endpoint 1 and the consumer report on
+ * endpoint 3; each is sent as soon as its own endpoint is free.
+ * Every encoder step is a one-shot key or consumer usage from the keymap
+ * layer it was taken in, so it costs a press and a release report; the
+ * scheduler keeps both going out back to back at the host polling rate and
+ * merges queued steps of the same layer, a turn back cancelling steps not
+ * reported yet. Wheel steps are a
+ * motion instead: all of them go out together in one mouse report, on
+ * endpoint 3 next to the consumer report.
+ * A playing macro owns the keyboard report between its press and release.
+ * A report only goes out when its content changes, or again when the idle
+ * rate the host set with SET_IDLE runs out; other poll slots stay empty.
+ * The first report to carry a button edge records its latency, and every
+ * encoder step that of the oldest detent not reported yet.
+ *
+ * Created: 17-Oct-26 2:15:37 PM
+ */ 
+
+#include <string.h>
+#include <avr/pgmspace.h>   /* need for usbdrv.h */
+
+#include "usbconfig.h"
+#include "usbdrv.h"
+
+#include "reportScheduler.h"
+#include "eventQueue.h"
+#include "timer2.h"
+#include "keyboard.h"
+#include "keymap.h"
+#include "macro.h"
+#include "latency.h"
+
+#include "USB/usb_hid_keys.h"
+#include "USB/usb_hid_consumer.h"
+
+#define THROUGHPUT_WINDOW_TICKS (1000 / TIMER2_TICK_MS)
+#define POLL_TICKS				(USB_CFG_INTR_POLL_INTERVAL / TIMER2_TICK_MS)
+#define IDLE_UNIT_TICKS			(4 / TIMER2_TICK_MS)
+
+// Steps waiting to be reported saturate like the encoder's own accumulator,
+// wheel motion at a full report of whole detents. Key and consumer steps
+// stop at ENCODER_ONESHOT_BACKLOG_MAX.
+#define ENCODER_BACKLOG_MAX		INT8_MAX
+#define WHEEL_BACKLOG_MAX		(MOUSE_WHEEL_MULTIPLIER * INT8_MAX)
+
+// Encoder events timed apart while their steps wait; later ones share the
+// newest entry and so are never reported earlier than they were.
+#define ENCODER_TIMES			8
+
+// Event source bit for the encoder, next to the buttons' (1 << BUTTON).
+#define WAIT_ENCODER			(1 << BUTTON_COUNT)
+
+// HID 1.11 recommends 500 ms for keyboards and infinity for everything else.
+#define IDLE_DEFAULT_KEYBOARD	125
+#define IDLE_DEFAULT_CONSUMER	0
+
+typedef struct
+{
+	uint8_t  reportId;                                 // Report ID = 0x01 (1)
+	// Collection: CA:ConsumerControl
+	uint16_t ConsumerControl[CONSUMER_ROLLOVER];       // Value = 0 to 668
+} inputConsumer_t;
+
+typedef struct
+{
+	uint8_t  reportId;                                 // Report ID = 0x02 (2)
+	// Collection: CA:Keyboard
+	uint8_t  Modifiers;                                // Usage 0x000700E0..E7: bit n = Left Control + n, Value = 0 to 1
+	uint8_t  Keyboard[KEYBOARD_ROLLOVER];              // Value = 0 to 255
+} inputKeyboard_t;
+
+typedef struct
+{
+	uint8_t  reportId;                                 // Report ID = 0x06 (6)
+	// Collection: CA:Mouse CP:Pointer
+	int8_t   X;                                        // Usage 0x00010030: X, Value = -127 to 127, always 0
+	int8_t   Y;                                        // Usage 0x00010031: Y, Value = -127 to 127, always 0
+	int8_t   Axis[MOUSE_AXIS_COUNT];                   // Wheel, AC Pan, Value = -127 to 127
+} inputMouse_t;
+
+static inputConsumer_t consumer_Report;
+static inputKeyboard_t keyboard_report; // sent to PC
+static inputMouse_t mouse_report;
+static uint8_t _resolution[MOUSE_FEATURE_LENGTH];	// REPORT_ID_MOUSE feature report
+static int16_t _wheelUnits[MOUSE_AXIS_COUNT];	// high resolution units not reported yet
+
+// Bit n stands for button n.
+static uint8_t _held;			// keys down, as far as the queue has been applied
+static uint8_t _reported;		// keys down, as the host has been told
+static uint8_t _consumerKeys;	// held keys that belong to the consumer report
+static KEYBOARD_ACTION _heldAction[KEYBOARD_MAX_KEYS];	// action taken at press
+
+static bool mustCloseConsumer;
+static bool mustCloseKeyboard;
+static int16_t encoderSteps;	// encoder steps not reported yet, clockwise positive
+static uint8_t encoderLayer;	// keymap layer of encoderSteps
+// Detent times of encoderSteps, oldest first, each with the steps that
+// came with it and are not reported yet.
+static uint16_t _encoderSince[ENCODER_TIMES];
+static uint8_t _encoderCount[ENCODER_TIMES];
+static uint8_t _encoderTimes;	// entries in use
+
+static uint8_t _buttonTimed;	// bit n: report ID n + 1 owes a button edge its latency
+static uint16_t _buttonSince[REPORT_COUNT];
+
+static uint8_t _idleRate[REPORT_COUNT];		// indexed by report ID - 1
+static uint16_t _lastSent[REPORT_COUNT];
+static uint16_t _slotStart;		// when the last poll slot was used or counted
+static REPORT_STATS _stats;
+
+static STEP_THROUGHPUT _window;
+static STEP_THROUGHPUT _lastSecond;
+static uint16_t _windowStart;
+
+static void buildKeyboardReport(uint8_t modifiers, const uint8_t *keys, uint8_t count) {
+	
+	keyboard_report.reportId = REPORT_ID_KEYBOARD;
+	keyboard_report.Modifiers = modifiers;
+	for(uint8_t i = 0; i < KEYBOARD_ROLLOVER; i++)
+	{
+		keyboard_report.Keyboard[i] = i < count ? keys[i] : KEY_NONE;
+	}
+	
+}
+
+static void buildConsumerReport(const uint16_t *usages, uint8_t count)
+{
+	consumer_Report.reportId = REPORT_ID_CONSUMER;
+	for(uint8_t i = 0; i < CONSUMER_ROLLOVER; i++)
+	{
+		consumer_Report.ConsumerControl[i] = i < count ? usages[i] : HID_CONSUMER_NONE;
+	}
+}
+
+static bool isKeyInReport(const uint8_t *keys, uint8_t count, uint8_t key)
+{
+	for(uint8_t i = 0; i < count; i++)
+	{
+		if(keys[i] == key)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static uint8_t reportInterface(uint8_t reportId)
+{
+	return reportId == REPORT_ID_KEYBOARD ? INTERFACE_KEYBOARD : INTERFACE_CONSUMER;
+}
+
+static bool isEndpointFree(uint8_t reportId)
+{
+	if (reportId == REPORT_ID_KEYBOARD)
+	{
+		return usbInterruptIsReady();
+	}
+	return usbInterruptIsReady3();
+}
+
+// Held keys that belong to a report.
+static uint8_t reportKeys(uint8_t reportId)
+{
+	if (reportId == REPORT_ID_MOUSE)
+	{
+		return 0;
+	}
+	return reportId == REPORT_ID_CONSUMER ? _consumerKeys : (uint8_t)~_consumerKeys;
+}
+
+static uint8_t encoderReportId(uint8_t layer, bool clockwise)
+{
+	KEYBOARD_ACTION action;
+	keyboard_get_encoder_action(layer, clockwise, &action);
+	return ACTION_CLASS_REPORT(keyboard_get_action_class(&action));
+}
+
+// Only the oldest edge per report is timed; later ones ride along.
+static void markButtonEdge(uint8_t reportId, uint16_t since)
+{
+	uint8_t bit = 1 << (reportId - 1);
+	
+	if (!(_buttonTimed & bit))
+	{
+		_buttonTimed |= bit;
+		_buttonSince[reportId - 1] = since;
+	}
+}
+
+static void sendReport(uint8_t reportId)
+{
+	uint8_t bit = 1 << (reportId - 1);
+	
+	if (_buttonTimed & bit)
+	{
+		_buttonTimed &= ~bit;
+		latency_record(LATENCY_BUTTON, _buttonSince[reportId - 1]);
+	}
+	if (reportId == REPORT_ID_CONSUMER)
+	{
+		usbSetInterrupt3((void *)&consumer_Report, sizeof(consumer_Report));
+	}
+	else if (reportId == REPORT_ID_MOUSE)
+	{
+		usbSetInterrupt3((void *)&mouse_report, sizeof(mouse_report));
+	}
+	else
+	{
+		usbSetInterrupt((void *)&keyboard_report, sizeof(keyboard_report));
+	}
+	_slotStart = timer2_get_ticks();
+	if (reportId <= REPORT_COUNT)
+	{
+		_lastSent[reportId - 1] = _slotStart;
+	}
+	_stats.sent++;
+}
+
+// Held consumer keys plus an optional extra usage, as an encoder step uses.
+// Keys past CONSUMER_ROLLOVER wait until a slot frees up.
+static void sendConsumerReport(uint16_t extra)
+{
+	uint16_t usages[CONSUMER_ROLLOVER];
+	uint8_t count = 0;
+	uint8_t held = _held & _consumerKeys;
+	
+	if (extra != HID_CONSUMER_NONE)
+	{
+		usages[count++] = extra;
+	}
+	for (uint8_t i = 0; held != 0 && count < CONSUMER_ROLLOVER; i++, held >>= 1)
+	{
+		uint16_t usage = KEYBOARD_ACTION_USAGE(&_heldAction[i]);
+		
+		if ((held & 1) && usage != HID_CONSUMER_NONE && usage != extra)
+		{
+			usages[count++] = usage;
+		}
+	}
+	buildConsumerReport(usages, count);
+	sendReport(REPORT_ID_CONSUMER);
+}
+
+// Held keyboard keys plus an optional extra key, as a macro step uses.
+static void sendKeyboardReport(uint8_t modifiers, uint8_t hidCode)
+{
+	uint8_t keys[KEYBOARD_ROLLOVER];
+	uint8_t count = 0;
+	uint8_t held = _held & ~_consumerKeys;
+	
+	if (hidCode != KEY_NONE)
+	{
+		keys[count++] = hidCode;
+	}
+	for (uint8_t i = 0; held != 0; i++, held >>= 1)
+	{
+		if (!(held & 1))
+		{
+			continue;
+		}
+		modifiers |= _heldAction[i].modifiers;
+		if (_heldAction[i].hidCode != KEY_NONE && count < KEYBOARD_ROLLOVER
+			&& !isKeyInReport(keys, count, _heldAction[i].hidCode))
+		{
+			keys[count++] = _heldAction[i].hidCode;
+		}
+	}
+	buildKeyboardReport(modifiers, keys, count);
+	sendReport(REPORT_ID_KEYBOARD);
+}
+
+// Sends the wheel motion the host takes at the resolution it set. At low
+// resolution only whole detents go out and the rest waits for more.
+static void sendMouseReport(void)
+{
+	bool moved = false;
+	
+	for (uint8_t axis = 0; axis < MOUSE_AXIS_COUNT; axis++)
+	{
+		int16_t scale = (_resolution[1] >> (2 * axis)) & 0x03 ? 1 : MOUSE_WHEEL_MULTIPLIER;
+		int16_t delta = _wheelUnits[axis] / scale;
+		
+		if (delta > INT8_MAX)
+		{
+			delta = INT8_MAX;
+		}
+		else if (delta < -INT8_MAX)
+		{
+			delta = -INT8_MAX;
+		}
+		_wheelUnits[axis] -= delta * scale;
+		mouse_report.Axis[axis] = (int8_t)delta;
+		moved |= delta != 0;
+	}
+	if (!moved)
+	{
+		return;
+	}
+	sendReport(REPORT_ID_MOUSE);
+}
+
+// Repeats the reports whose idle period ran out.
+static void sendIdleRepeats(void)
+{
+	uint16_t now = timer2_get_ticks();
+	
+	for (uint8_t i = 0; i < REPORT_COUNT; i++)
+	{
+		if (_idleRate[i] != 0 && isEndpointFree(i + 1)
+			&& (uint16_t)(now - _lastSent[i]) >= (uint16_t)_idleRate[i] * IDLE_UNIT_TICKS)
+		{
+			sendReport(i + 1);
+		}
+	}
+}
+
+// Counts the poll slots that passed without a report.
+static void countSuppressed(void)
+{
+	uint16_t now = timer2_get_ticks();
+	
+	while ((uint16_t)(now - _slotStart) >= POLL_TICKS)
+	{
+		_slotStart += POLL_TICKS;
+		_stats.suppressed++;
+	}
+}
+
+static void timeSteps(uint8_t count, uint16_t since)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	if (_encoderTimes == ENCODER_TIMES)
+	{
+		_encoderCount[ENCODER_TIMES - 1] += count;
+		return;
+	}
+	_encoderSince[_encoderTimes] = since;
+	_encoderCount[_encoderTimes] = count;
+	_encoderTimes++;
+}
+
+// Steps taken back are the newest ones.
+static void untimeSteps(uint8_t count)
+{
+	while (count != 0 && _encoderTimes != 0)
+	{
+		uint8_t *newest = &_encoderCount[_encoderTimes - 1];
+		uint8_t n = count < *newest ? count : *newest;
+		
+		*newest -= n;
+		count -= n;
+		if (*newest == 0)
+		{
+			_encoderTimes--;
+		}
+	}
+}
+
+// Records the latency of the oldest step waiting, which is being reported.
+static void recordStep(void)
+{
+	if (_encoderTimes == 0)
+	{
+		return;
+	}
+	latency_record(LATENCY_ENCODER, _encoderSince[0]);
+	if (--_encoderCount[0] == 0)
+	{
+		_encoderTimes--;
+		memmove(_encoderSince, _encoderSince + 1, _encoderTimes * sizeof(_encoderSince[0]));
+		memmove(_encoderCount, _encoderCount + 1, _encoderTimes);
+	}
+}
+
+// Steps against the direction waiting take those back first, so turning
+// the knob back is not queued behind a backlog.
+static void addEncoderSteps(int8_t steps, uint16_t since)
+{
+	int16_t total = encoderSteps + steps;
+	int16_t max = encoderReportId(encoderLayer, total > 0) == REPORT_ID_MOUSE
+		? ENCODER_BACKLOG_MAX : ENCODER_ONESHOT_BACKLOG_MAX;
+	uint8_t before = encoderSteps < 0 ? -encoderSteps : encoderSteps;
+	uint8_t after;
+	
+	_window.requested += steps < 0 ? -steps : steps;
+	if (total > max)
+	{
+		total = max;
+	}
+	else if (total < -max)
+	{
+		total = -max;
+	}
+	after = total < 0 ? -total : total;
+	if (total != 0 && encoderSteps != 0 && (total < 0) != (encoderSteps < 0))
+	{
+		// Turned back past every step waiting.
+		untimeSteps(before);
+		before = 0;
+	}
+	if (after > before)
+	{
+		timeSteps(after - before, since);
+	}
+	else
+	{
+		untimeSteps(before - after);
+	}
+	encoderSteps = total;
+}
+
+// Applies a key event to the held keys, or starts its macro. Returns false
+// if it has to wait; 'reportId' gets the report it belongs to either way.
+static bool applyKeyEvent(const INPUT_EVENT *event, uint8_t waitReports, uint8_t *reportId)
+{
+	uint8_t pending = _held ^ _reported;
+	uint8_t btn = KEYBOARD_EVENT_KEY(event->value);
+	uint8_t bit = 1 << btn;
+	KEYBOARD_ACTION action;
+	uint8_t actionClass = 0;
+	
+	*reportId = (_consumerKeys & bit) ? REPORT_ID_CONSUMER : REPORT_ID_KEYBOARD;
+	if (event->type == EVENT_KEY_PRESSED)
+	{
+		keyboard_get_action(event->layer, event->value, &action);
+		actionClass = keyboard_get_action_class(&action);
+		*reportId = ACTION_CLASS_REPORT(actionClass);
+	}
+	if ((pending & bit) || (waitReports & (1 << *reportId))
+		|| (encoderSteps != 0 && *reportId == encoderReportId(encoderLayer, encoderSteps > 0)))
+	{
+		return false;
+	}
+	if (event->type == EVENT_KEY_PRESSED)
+	{
+		if (*reportId == 0)
+		{
+			// A layer action as a gesture's alt, nothing to report.
+			return true;
+		}
+		if (!(actionClass & ACTION_CLASS_HELD))
+		{
+			// A macro, the only action queued that is not held. It starts
+			// once the keyboard report is settled, the last one is done
+			// and no new map is arriving over the steps.
+			if ((pending & reportKeys(REPORT_ID_KEYBOARD)) || macro_is_running() || keymap_is_receiving())
+			{
+				return false;
+			}
+			macro_start(action.hidCode);
+			markButtonEdge(REPORT_ID_KEYBOARD, event->timestamp);
+			return true;
+		}
+		_heldAction[btn] = action;
+		if (*reportId == REPORT_ID_CONSUMER)
+		{
+			_consumerKeys |= bit;
+		}
+		else
+		{
+			_consumerKeys &= ~bit;
+		}
+		_held |= bit;
+	}
+	else if (_held & bit)
+	{
+		_held &= ~bit;
+	}
+	else
+	{
+		// Release of a macro key, nothing to report.
+		return true;
+	}
+	markButtonEdge(*reportId, event->timestamp);
+	return true;
+}
+
+// Adds an encoder event to the steps waiting, which must be of its layer.
+// Returns false if it has to wait; 'reportId' gets the report of its steps.
+static bool applyEncoderEvent(const INPUT_EVENT *event, uint8_t waitReports, uint8_t *reportId)
+{
+	int8_t steps = (int8_t)event->value;
+	
+	*reportId = encoderReportId(event->layer, steps > 0);
+	if ((waitReports & (1 << *reportId)) || (encoderSteps != 0 ? event->layer != encoderLayer
+		: ((_held ^ _reported) & reportKeys(*reportId)) != 0))
+	{
+		return false;
+	}
+	encoderLayer = event->layer;
+	addEncoderSteps(steps, event->timestamp);
+	return true;
+}
+
+static void updateThroughput(void)
+{
+	uint16_t now = timer2_get_ticks();
+	
+	if((uint16_t)(now - _windowStart) >= THROUGHPUT_WINDOW_TICKS)
+	{
+		_lastSecond = _window;
+		_window.requested = 0;
+		_window.delivered = 0;
+		_windowStart = now;
+	}
+}
+
+void reportScheduler_init(void)
+{
+	_held = 0;
+	_reported = 0;
+	_consumerKeys = 0;
+	mustCloseConsumer = false;
+	mustCloseKeyboard = false;
+	encoderSteps = 0;
+	_encoderTimes = 0;
+	_buttonTimed = 0;
+	latency_init();
+	buildConsumerReport(NULL, 0);
+	buildKeyboardReport(0, NULL, 0);
+	memset(&mouse_report, 0, sizeof(mouse_report));
+	mouse_report.reportId = REPORT_ID_MOUSE;
+	memset(_wheelUnits, 0, sizeof(_wheelUnits));
+	_resolution[0] = REPORT_ID_MOUSE;
+	_resolution[1] = 0;
+	_idleRate[REPORT_ID_CONSUMER - 1] = IDLE_DEFAULT_CONSUMER;
+	_idleRate[REPORT_ID_KEYBOARD - 1] = IDLE_DEFAULT_KEYBOARD;
+	_windowStart = _slotStart = timer2_get_ticks();
+	_lastSent[REPORT_ID_CONSUMER - 1] = _lastSent[REPORT_ID_KEYBOARD - 1] = _windowStart;
+}
+
+void reportScheduler_poll(void)
+{
+	INPUT_EVENT event;
+	uint8_t index = 0;
+	uint8_t waitSources = 0;	// buttons and WAIT_ENCODER with an event left queued
+	uint8_t waitReports = 0;	// bit n: report ID n has an event left queued
+	uint8_t macroModifiers;
+	uint8_t macroKey;
+	uint16_t sent = _stats.sent;
+	
+	updateThroughput();
+	
+	if(!usbInterruptIsReady() && !usbInterruptIsReady3())
+	{
+		return;
+	}
+	
+	if (mustCloseConsumer && isEndpointFree(REPORT_ID_CONSUMER))
+	{
+		mustCloseConsumer = false;
+		sendConsumerReport(HID_CONSUMER_NONE);
+	}
+	
+	if (mustCloseKeyboard && isEndpointFree(REPORT_ID_KEYBOARD))
+	{
+		mustCloseKeyboard = false;
+		sendKeyboardReport(0, KEY_NONE);
+	}
+	
+	if (isEndpointFree(REPORT_ID_KEYBOARD) && macro_poll(&macroModifiers, &macroKey))
+	{
+		sendKeyboardReport(macroModifiers, macroKey);
+	}
+	
+	// Apply events to the held keys and encoder steps, oldest first. One
+	// that has to wait, for a key change the host has not been told about
+	// yet or for encoder steps of its report, stays queued and holds back
+	// the later events of its button, or of the encoder, and of its report;
+	// the rest go past it. All changes applied go out together, and a key
+	// press is not held up by a volume spin or the other way round.
+	while (eventQueue_peek(index, &event))
+	{
+		uint8_t source = event.type == EVENT_ENCODER ? WAIT_ENCODER : 1 << KEYBOARD_EVENT_KEY(event.value);
+		uint8_t reportId = 0;
+		
+		if (!(waitSources & source) && (event.type == EVENT_ENCODER
+			? applyEncoderEvent(&event, waitReports, &reportId) : applyKeyEvent(&event, waitReports, &reportId)))
+		{
+			eventQueue_remove(index);
+			continue;
+		}
+		waitSources |= source;
+		waitReports |= 1 << reportId;
+		index++;
+	}
+	
+	if (((_held ^ _reported) & ~_consumerKeys) && isEndpointFree(REPORT_ID_KEYBOARD))
+	{
+		_reported = (_reported & _consumerKeys) | (_held & ~_consumerKeys);
+		sendKeyboardReport(0, KEY_NONE);
+	}
+	
+	if (((_held ^ _reported) & _consumerKeys) && isEndpointFree(REPORT_ID_CONSUMER))
+	{
+		_reported = (_reported & ~_consumerKeys) | (_held & _consumerKeys);
+		sendConsumerReport(HID_CONSUMER_NONE);
+	}
+	
+	if (encoderSteps != 0)
+	{
+		KEYBOARD_ACTION action;
+		keyboard_get_encoder_action(encoderLayer, encoderSteps > 0, &action);
+		uint8_t reportId = encoderReportId(encoderLayer, encoderSteps > 0);
+		
+		if (reportId == REPORT_ID_MOUSE)
+		{
+			// Every step waiting joins the motion once the endpoint is
+			// free, and the report below carries it. Wheel steps are
+			// accelerated, so each encoder event rather than each step is
+			// timed.
+			if (isEndpointFree(REPORT_ID_MOUSE))
+			{
+				uint8_t steps = encoderSteps < 0 ? -encoderSteps : encoderSteps;
+				int16_t units = _wheelUnits[action.hidCode] + steps * (int8_t)action.modifiers;
+				
+				_wheelUnits[action.hidCode] = units > WHEEL_BACKLOG_MAX ? WHEEL_BACKLOG_MAX
+					: units < -WHEEL_BACKLOG_MAX ? -WHEEL_BACKLOG_MAX : units;
+				_window.delivered += steps;
+				encoderSteps = 0;
+				for (; _encoderTimes != 0; _encoderTimes--)
+				{
+					latency_record(LATENCY_ENCODER, _encoderSince[_encoderTimes - 1]);
+				}
+			}
+		}
+		// Anything else due on the same endpoint went out above; the step
+		// only waits for its own endpoint. A report's array cannot repeat
+		// a usage as separate presses, so each step takes a report and the
+		// release after it: 50 steps/s at a 10 ms poll, which
+		// ENCODER_ONESHOT_BACKLOG_MAX keeps from trailing the knob.
+		else if (isEndpointFree(reportId))
+		{
+			encoderSteps += encoderSteps < 0 ? 1 : -1;
+			_window.delivered++;
+			recordStep();
+			
+			if (reportId == REPORT_ID_CONSUMER)
+			{
+				// The step joins the held consumer keys for its length.
+				mustCloseConsumer = true;
+				sendConsumerReport(KEYBOARD_ACTION_USAGE(&action));
+			}
+			else
+			{
+				mustCloseKeyboard = true;
+				sendKeyboardReport(action.modifiers, action.hidCode);
+			}
+		}
+	}
+	
+	if (isEndpointFree(REPORT_ID_MOUSE))
+	{
+		sendMouseReport();
+	}
+	
+	sendIdleRepeats();
+	if (_stats.sent == sent)
+	{
+		countSuppressed();
+	}
+}
+
+uint8_t reportScheduler_get_report(uint8_t reportId, uint8_t **report)
+{
+	if (reportId == REPORT_ID_CONSUMER)
+	{
+		*report = (uint8_t *)&consumer_Report;
+		return sizeof(consumer_Report);
+	}
+	
+	if (reportId == REPORT_ID_KEYBOARD)
+	{
+		*report = (uint8_t *)&keyboard_report;
+		return sizeof(keyboard_report);
+	}
+	
+	return 0;
+}
+
+uint8_t reportScheduler_get_resolution(uint8_t **report)
+{
+	*report = _resolution;
+	return sizeof(_resolution);
+}
+
+void reportScheduler_set_resolution(const uint8_t *report, uint8_t len)
+{
+	if (len == sizeof(_resolution) && report[0] == REPORT_ID_MOUSE)
+	{
+		_resolution[1] = report[1];
+	}
+}
+
+static bool isIdleReport(uint8_t interface, uint8_t reportId, uint8_t index)
+{
+	return reportInterface(index + 1) == interface && (reportId == 0 || reportId == index + 1);
+}
+
+void reportScheduler_set_idle(uint8_t interface, uint8_t reportId, uint8_t rate)
+{
+	for (uint8_t i = 0; i < REPORT_COUNT; i++)
+	{
+		if (isIdleReport(interface, reportId, i))
+		{
+			_idleRate[i] = rate;
+		}
+	}
+}
+
+uint8_t reportScheduler_get_idle(uint8_t interface, uint8_t reportId)
+{
+	for (uint8_t i = 0; i < REPORT_COUNT; i++)
+	{
+		if (isIdleReport(interface, reportId, i))
+		{
+			return _idleRate[i];
+		}
+	}
+	return 0;
+}
+
+void reportScheduler_get_stats(REPORT_STATS *stats)
+{
+	*stats = _stats;
+}
+
+void reportScheduler_get_throughput(STEP_THROUGHPUT *throughput)
+{
+	*throughput = _lastSecond;
+}
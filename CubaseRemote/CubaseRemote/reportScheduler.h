@@ -0,0 +1,87 @@
+/*
+ * reportScheduler.h
+ *
+ * Created: 17-Oct-26 2:14:51 PM
+ */ 
+
+
+#ifndef REPORTSCHEDULER_H_
+#define REPORTSCHEDULER_H_
+
+#include "globals.h"
+
+#define REPORT_ID_CONSUMER	1
+#define REPORT_ID_KEYBOARD	2
+#define REPORT_COUNT		2	// key report IDs run 1..REPORT_COUNT
+#define REPORT_ID_KEYMAP	3	// feature report, see keymap.h
+#define REPORT_ID_PROFILE	4	// feature report of the PROFILER build, see profiler.h
+#define REPORT_ID_LATENCY	5	// feature report, see latency.h
+#define REPORT_ID_MOUSE		6	// wheel input, resolution multiplier feature
+
+// Interface numbers, see the configuration descriptor in main.c.
+#define INTERFACE_KEYBOARD	0	// keyboard and feature reports, endpoint 1
+#define INTERFACE_CONSUMER	1	// consumer control and wheel, endpoint 3
+
+#define KEYBOARD_ROLLOVER	6	// key slots in the keyboard report
+#define CONSUMER_ROLLOVER	3	// usage slots in the consumer report, 16 bits each
+
+// Key and consumer steps of the encoder waiting to be reported. Each takes
+// a press and a release report, two poll intervals, so these go out within
+// 100 ms of the knob stopping; a faster spin loses the steps beyond them
+// rather than keep acting after it.
+#define ENCODER_ONESHOT_BACKLOG_MAX	5
+
+// Wheel units per detent once the host sets the resolution multiplier;
+// until then a wheel unit is a whole detent.
+#define MOUSE_WHEEL_MULTIPLIER	4
+
+// Axes of the mouse report an ACTION_WHEEL moves.
+#define MOUSE_AXIS_WHEEL	0	// vertical scroll
+#define MOUSE_AXIS_PAN		1	// AC Pan, horizontal scroll
+#define MOUSE_AXIS_COUNT	2
+
+// REPORT_ID_MOUSE feature report: report ID, then 2 bits per axis, set
+// for high resolution.
+#define MOUSE_FEATURE_LENGTH	2
+
+typedef struct
+{
+	uint16_t requested;		// encoder steps that reached the scheduler
+	uint16_t delivered;		// encoder steps handed to the host
+} STEP_THROUGHPUT;
+
+typedef struct
+{
+	uint16_t sent;			// reports handed to the driver
+	uint16_t suppressed;	// poll intervals that passed without a report
+} REPORT_STATS;
+
+void reportScheduler_init(void);
+
+// Hands the next keyboard, consumer and mouse reports to the driver, each
+// if its interrupt-IN endpoint is free. Call once per main loop pass.
+void reportScheduler_poll(void);
+
+// Current content of a report, answered to USBRQ_HID_GET_REPORT.
+// Returns its length, 0 for an unknown report ID.
+uint8_t reportScheduler_get_report(uint8_t reportId, uint8_t **report);
+
+// The REPORT_ID_MOUSE feature report, for USBRQ_HID_GET_REPORT and
+// USBRQ_HID_SET_REPORT.
+uint8_t reportScheduler_get_resolution(uint8_t **report);
+void reportScheduler_set_resolution(const uint8_t *report, uint8_t len);
+
+// HID idle rate in 4 ms units, 0 = send on change only, of the key reports
+// on 'interface' (wIndex). Report ID 0 addresses every key report of the
+// interface; wheel motion is never repeated.
+void reportScheduler_set_idle(uint8_t interface, uint8_t reportId, uint8_t rate);
+uint8_t reportScheduler_get_idle(uint8_t interface, uint8_t reportId);
+
+// Running totals since reset, both wrap at 16 bits.
+void reportScheduler_get_stats(REPORT_STATS *stats);
+
+// Encoder steps over the last completed second.
+void reportScheduler_get_throughput(STEP_THROUGHPUT *throughput);
+
+
+#endif /* REPORTSCHEDULER_H_ */
\ No newline at end of file
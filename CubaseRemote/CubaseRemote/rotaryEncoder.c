@@ -60,8 +60,11 @@
 * than 10 lines of logic.
 */
 
+#include <string.h>
 #include <avr/io.h>
+#include <util/atomic.h>
 #include "rotaryEncoder.h"
+#include "timer2.h"
 
 #define ENCODER_PORT PORTD
 #define ENCODER_DDR DDRD
@@ -71,8 +74,14 @@
 #define ENCODER_PIN2 PIND7
 
 static unsigned char _state;
-static unsigned char _eventIsUsed;
-static unsigned char _rotaryEncoder_direction;
+static volatile int8_t _delta;
+static uint16_t _deltaSince;	// first detent in _delta
+
+#ifdef ENCODER_ACCELERATION
+static uint16_t _lastDetentTick;
+static unsigned char _lastDirection;
+static struct ENCODER_ACCEL_POINT _accelCurve[ENCODER_ACCEL_POINTS];	// the interrupt's own copy
+#endif
 
 // No complete step yet.
 #define DIR_NONE 0x0
@@ -151,8 +160,52 @@ void rotaryEncoder_init() {
 #endif
 	// Initialise state.
 	_state = R_START;
-	_eventIsUsed = 0;
-	_rotaryEncoder_direction = DIR_NONE;
+	_delta = 0;
+}
+
+static int8_t rotaryEncoder_add(int8_t total, int8_t steps)
+{
+	int16_t sum = total + steps;
+	
+	if(sum > INT8_MAX)
+	{
+		return INT8_MAX;
+	}
+	if(sum < INT8_MIN)
+	{
+		return INT8_MIN;
+	}
+	return (int8_t)sum;
+}
+
+/*
+* Number of steps one detent is worth, from the time since the previous
+* detent in the same direction.
+*/
+static int8_t rotaryEncoder_detent_steps(unsigned char direction)
+{
+#ifdef ENCODER_ACCELERATION
+	uint16_t now = timer2_get_ticks();
+	uint16_t interval = (now - _lastDetentTick) * TIMER2_TICK_MS;
+	bool sameDirection = direction == _lastDirection;
+	
+	_lastDetentTick = now;
+	_lastDirection = direction;
+	
+	if(sameDirection)
+	{
+		for(uint8_t i = 0; i < ENCODER_ACCEL_POINTS && _accelCurve[i].steps != 0; i++)
+		{
+			if(interval <= _accelCurve[i].interval)
+			{
+				return (int8_t)_accelCurve[i].steps;
+			}
+		}
+	}
+#else
+	(void)direction;
+#endif
+	return 1;
 }
 
 void rotaryEncoder_process() {
@@ -169,24 +222,42 @@ void rotaryEncoder_process() {
 	
 	// Determine new state from the pins and state table.
 	_state = ttable[_state & 0xf][pinstate];
-	// Return emit bits, ie the generated event.
-	if(_eventIsUsed || ((_state & 0x30) != DIR_NONE) ) 
+	// Accumulate the emitted step, if any.
+	unsigned char direction = _state & 0x30;
+	if(direction == DIR_NONE)
+	{
+		return;
+	}
+	
+	if(_delta == 0)
 	{
-		_rotaryEncoder_direction = _state & 0x30;
-		_eventIsUsed = 0;
+		_deltaSince = timer2_get_samples();
 	}
+	int8_t sign = direction == DIR_CW ? ENCODER_STEP_CW : ENCODER_STEP_CCW;
+	_delta = rotaryEncoder_add(_delta, rotaryEncoder_detent_steps(direction) * sign);
 }
 
-ENCODER_SPIN_DIRECTION rotaryEncoder_get_direction()
+void rotaryEncoder_set_accel_curve(const struct ENCODER_ACCEL_POINT *curve)
 {
-	_eventIsUsed = 1;
-	switch(_rotaryEncoder_direction)
+#ifdef ENCODER_ACCELERATION
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		memcpy(_accelCurve, curve, sizeof(_accelCurve));
+	}
+#else
+	(void)curve;
+#endif
+}
+
+int8_t rotaryEncoder_take_delta(uint16_t *since)
+{
+	int8_t delta;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
 	{
-		case DIR_CCW:
-			return ENCODER_SPIN_DIRECTION_LEFT;
-		case DIR_CW:
-			return ENCODER_SPIN_DIRECTION_RIGHT;
-		default:
-			return ENCODER_SPIN_DIRECTION_NONE;
+		*since = _deltaSince;
+		delta = _delta;
+		_delta = 0;
 	}
+	return delta;
 }
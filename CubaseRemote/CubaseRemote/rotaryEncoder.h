@@ -9,6 +9,8 @@
 #ifndef ROTARYENCODER_H_
 #define ROTARYENCODER_H_
 
+#include "globals.h"
+
 
 // Enable this to emit codes twice per step.
 //#define HALF_STEP
@@ -16,16 +18,41 @@
 // Enable weak pullups
 #define ENABLE_PULLUPS
 
-typedef enum _ENCODER_SPIN
+// Enable velocity acceleration: a detent that follows the previous one in
+// the same direction within a curve entry's interval (ms) counts as that
+// entry's number of steps. Entries are checked top to bottom up to the
+// first one with 0 steps, slower detents count as one step.
+// Every action takes the accelerated count. Key and consumer steps go out
+// one per press/release pair, so the report scheduler only keeps as many
+// of them waiting as it drains in ENCODER_ONESHOT_BACKLOG_MAX pairs.
+// The curve is part of the keymap (see keymap.h); ENCODER_ACCEL_CURVE is
+// its default.
+#define ENCODER_ACCELERATION
+#define ENCODER_ACCEL_CURVE		{ { 8, 6 }, { 16, 4 }, { 32, 2 } }
+#define ENCODER_ACCEL_POINTS	3
+
+struct ENCODER_ACCEL_POINT
 {
-	ENCODER_SPIN_DIRECTION_NONE = 0x00,
-	ENCODER_SPIN_DIRECTION_LEFT	= 0x10,
-	ENCODER_SPIN_DIRECTION_RIGHT= 0x20,
-} ENCODER_SPIN_DIRECTION;
+	uint8_t interval;	// ms since the previous detent
+	uint8_t steps;		// at most INT8_MAX
+};
+
+// Steps are accumulated as a signed count, clockwise positive.
+#define ENCODER_STEP_CW		(1)
+#define ENCODER_STEP_CCW	(-1)
 
 void rotaryEncoder_init();
+
+// Called from the timer2 interrupt at a fixed rate.
 void rotaryEncoder_process();
-ENCODER_SPIN_DIRECTION rotaryEncoder_get_direction();
+
+// Takes a copy of the acceleration curve for the interrupt, so a keymap
+// being received in place never changes it halfway through a lookup.
+void rotaryEncoder_set_accel_curve(const struct ENCODER_ACCEL_POINT *curve);
+
+// Returns the steps accumulated since the last call and clears them.
+// 'since' gets the timer2_get_samples() of the first of those detents.
+int8_t rotaryEncoder_take_delta(uint16_t *since);
 
 
 
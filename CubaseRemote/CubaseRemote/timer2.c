@@ -6,22 +6,75 @@
  */ 
 
 #include <avr/interrupt.h>
+#include <util/atomic.h>
 
 #include "timer2.h"
 
 #include "Button_debounce.h"
+#include "rotaryEncoder.h"
+#include "profiler.h"
 
+#define BUTTON_SCAN_DIVIDER (BUTTON_SCAN_MS / TIMER2_TICK_MS)
+
+static volatile uint16_t _ticks;
+static volatile uint16_t _samples;
 
 void timer2_init() {
-	TCCR2 = ( 1 << CS20 ) | ( 1 << CS21 ) | ( 1 << CS22 );// prescaler 64
+	TCCR2 = ( 1 << CS21 ) | ( 1 << CS20 );// prescaler 32
 	TCCR2 |= ( 1 << WGM21 ); //CTC mode
-	OCR2 = 0x9B;// 10 ms at 16Mhz
+	OCR2 = 124;// 250 us at 16Mhz
 	
 	TIMSK = ( 1 << OCIE2 ); // enable interrupt
 }
 
-ISR(TIMER2_COMP_vect) {
+uint16_t timer2_get_ticks(void)
+{
+	uint16_t ticks;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ticks = _ticks;
+	}
+	return ticks;
+}
+
+uint16_t timer2_get_samples(void)
+{
+	uint16_t samples;
 	
-	button_routine();
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		samples = _samples;
+	}
+	return samples;
+}
+
+static void timer2_tick(void)
+{
+	static uint8_t sampleDivider;
+	static uint8_t buttonDivider;
 	
+	_samples++;
+	
+	// The encoder is sampled on every interrupt, fast enough to see each
+	// quarter step of a quick spin.
+	PROFILE(PROFILE_ENCODER_SAMPLE, rotaryEncoder_process());
+	
+	if(++sampleDivider < TIMER2_SAMPLES_PER_TICK)
+	{
+		return;
+	}
+	sampleDivider = 0;
+	_ticks++;
+	
+	if(++buttonDivider >= BUTTON_SCAN_DIVIDER)
+	{
+		buttonDivider = 0;
+		PROFILE(PROFILE_BUTTON_SCAN, button_routine());
+	}
+}
+
+// Non-blocking, so the V-USB interrupt is never held off by the scan.
+ISR(TIMER2_COMP_vect, ISR_NOBLOCK) {
+	PROFILE(PROFILE_TIMER2_ISR, timer2_tick());
 }
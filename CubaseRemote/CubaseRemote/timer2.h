@@ -11,7 +11,15 @@
 
 #include "globals.h"
 
+#define TIMER2_TICK_MS 1
+#define TIMER2_SAMPLES_PER_TICK 4	// interrupts per tick, one every 250 us
 
 void timer2_init();
 
+uint16_t timer2_get_ticks(void);
+
+// Interrupts since start, one every 250 us; the time base for latency
+// measurements, see latency.h.
+uint16_t timer2_get_samples(void);
+
 #endif /* TIMER2_H_ */
\ No newline at end of file
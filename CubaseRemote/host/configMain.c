@@ -0,0 +1,261 @@
+/*
+ * configMain.c
+ *
+ * Configurator for the Cubase remote. The keymap, the macros and the
+ * encoder acceleration curve travel together in the REPORT_ID_KEYMAP
+ * feature report, so every command reads the whole image in one transfer
+ * and an upload writes it back in one transfer:
+ *
+ *   dump [file]     write the device's keymap as text, to stdout by default
+ *   diff <file>     show what uploading <file> would change
+ *   upload <file>   apply <file> to the device's keymap, write it if anything
+ *                   changed and read it back to check
+ *   verify <file>   exit with 1 unless the device already matches <file>
+ *   latency         print the device's input latency histograms, which
+ *                   starts them over
+ *
+ * A file only needs the entries it changes, see keymapText.c for the format;
+ * the output of 'dump' is a complete one.
+ *
+ * Created: 17-Oct-26 7:20:06 PM
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hiddata.h"
+#include "keymapText.h"
+#include "latency.h"
+#include "reportScheduler.h"
+
+// USB_CFG_VENDOR_ID, USB_CFG_DEVICE_ID and the names in usbconfig.h
+#define DEVICE_VID			0x16c0
+#define DEVICE_PID			0x27db
+#define DEVICE_VENDOR		"Vlad Tht"
+#define DEVICE_PRODUCT		"Cubase remote"
+
+// A full keymap takes about 2 s to save, see eepromWriter.c.
+#define WRITE_RETRY_MS		100
+#define WRITE_RETRIES		30
+
+static bool read_keymap(usbDevice_t *dev, KEYMAP_IMAGE *image)
+{
+	char buffer[KEYMAP_REPORT_LENGTH + 1];
+	int len = sizeof(buffer);
+	int err = usbhidGetReport(dev, REPORT_ID_KEYMAP, buffer, &len);
+
+	if(err != 0)
+	{
+		fprintf(stderr, "reading the keymap failed (%d)\n", err);
+		return false;
+	}
+	if(len != KEYMAP_REPORT_LENGTH || buffer[0] != REPORT_ID_KEYMAP)
+	{
+		fprintf(stderr, "unexpected keymap report, %d bytes\n", len);
+		return false;
+	}
+	memcpy(image, &buffer[1], sizeof(*image));
+	if(image->version != KEYMAP_VERSION || image->crc != keymap_image_crc(image))
+	{
+		fprintf(stderr, "device keymap is version %u, this tool speaks version %u\n", image->version, KEYMAP_VERSION);
+		return false;
+	}
+	return true;
+}
+
+static bool write_keymap(usbDevice_t *dev, KEYMAP_IMAGE *image)
+{
+	char buffer[KEYMAP_REPORT_LENGTH];
+	int err;
+
+	image->crc = keymap_image_crc(image);
+	buffer[0] = REPORT_ID_KEYMAP;
+	memcpy(&buffer[1], image, sizeof(*image));
+	// The firmware stalls the transfer if it rejects the map, and also
+	// while it still saves the last one, which can take a few seconds.
+	for(int tries = 0; (err = usbhidSetReport(dev, buffer, sizeof(buffer))) != 0 && tries < WRITE_RETRIES; tries++)
+	{
+		usleep(WRITE_RETRY_MS * 1000);
+	}
+	if(err != 0)
+	{
+		fprintf(stderr, "writing the keymap failed (%d)\n", err);
+		return false;
+	}
+	return true;
+}
+
+static bool load_file(const char *path, KEYMAP_IMAGE *image)
+{
+	FILE *f = fopen(path, "r");
+	bool ok;
+
+	if(f == NULL)
+	{
+		perror(path);
+		return false;
+	}
+	ok = keymap_text_parse(f, path, image);
+	fclose(f);
+	return ok;
+}
+
+static int dump(const KEYMAP_IMAGE *device, const char *path)
+{
+	FILE *f = path ? fopen(path, "w") : stdout;
+
+	if(f == NULL)
+	{
+		perror(path);
+		return 1;
+	}
+	keymap_text_print(f, device);
+	if(f != stdout && fclose(f) != 0)
+	{
+		perror(path);
+		return 1;
+	}
+	return 0;
+}
+
+static int upload(usbDevice_t *dev, KEYMAP_IMAGE *wanted)
+{
+	KEYMAP_IMAGE readBack;
+
+	if(!write_keymap(dev, wanted) || !read_keymap(dev, &readBack))
+	{
+		return 1;
+	}
+	if(memcmp(&readBack, wanted, sizeof(readBack)) != 0)
+	{
+		fprintf(stderr, "read back differs from what was written:\n");
+		keymap_text_diff(stderr, wanted, &readBack);
+		return 1;
+	}
+	printf("written and verified\n");
+	return 0;
+}
+
+static int latency(usbDevice_t *dev)
+{
+	static const char *const names[LATENCY_SOURCE_COUNT] = { "button", "encoder" };
+	char buffer[LATENCY_REPORT_LENGTH + 1];
+	int len = sizeof(buffer);
+	int err = usbhidGetReport(dev, REPORT_ID_LATENCY, buffer, &len);
+	double unit;
+
+	if(err != 0)
+	{
+		fprintf(stderr, "reading the latency report failed (%d)\n", err);
+		return 1;
+	}
+	if(len != LATENCY_REPORT_LENGTH || buffer[0] != REPORT_ID_LATENCY)
+	{
+		fprintf(stderr, "unexpected latency report, %d bytes\n", len);
+		return 1;
+	}
+	unit = (uint8_t)buffer[1] * 10 / 1000.0;
+	for(uint8_t i = 0; i < LATENCY_SOURCE_COUNT; i++)
+	{
+		struct LATENCY_HISTOGRAM h;
+
+		memcpy(&h, &buffer[2 + i * sizeof(h)], sizeof(h));
+		printf("%s: %u reports", names[i], h.count);
+		if(h.count != 0)
+		{
+			printf(", avg %.3f ms, max %.3f ms", (double)h.total / h.count * unit, h.max * unit);
+		}
+		printf("\n");
+		for(uint8_t b = 0; b < LATENCY_BUCKETS; b++)
+		{
+			if(h.buckets[b] == 0)
+			{
+				continue;
+			}
+			if(b == LATENCY_BUCKETS - 1)
+			{
+				printf("  %8.2f ms and up %6u\n", (1u << (b - 1)) * unit, h.buckets[b]);
+			}
+			else
+			{
+				printf("  under %8.2f ms %6u\n", (1u << b) * unit, h.buckets[b]);
+			}
+		}
+	}
+	return 0;
+}
+
+static void usage(const char *argv0)
+{
+	fprintf(stderr,
+		"usage: %s dump [file]\n"
+		"       %s diff|upload|verify <file>\n"
+		"       %s latency\n",
+		argv0, argv0, argv0);
+}
+
+int main(int argc, char **argv)
+{
+	usbDevice_t *dev;
+	KEYMAP_IMAGE device, wanted;
+	const char *cmd = argc > 1 ? argv[1] : "";
+	const char *path = argc > 2 ? argv[2] : NULL;
+	bool isDump = strcmp(cmd, "dump") == 0;
+	bool isLatency = strcmp(cmd, "latency") == 0;
+	int err, result = 0;
+
+	if(isLatency ? argc > 2 : argc > 3 || (!isDump && (path == NULL || (strcmp(cmd, "diff") != 0
+		&& strcmp(cmd, "upload") != 0 && strcmp(cmd, "verify") != 0))))
+	{
+		usage(argv[0]);
+		return 2;
+	}
+	err = usbhidOpenDevice(&dev, DEVICE_VID, DEVICE_VENDOR, DEVICE_PID, DEVICE_PRODUCT, 1);
+	if(err != 0)
+	{
+		fprintf(stderr, "cannot open %s (%d)\n", DEVICE_PRODUCT, err);
+		return 1;
+	}
+	if(isLatency)
+	{
+		result = latency(dev);
+		usbhidCloseDevice(dev);
+		return result;
+	}
+	if(!read_keymap(dev, &device))
+	{
+		usbhidCloseDevice(dev);
+		return 1;
+	}
+
+	if(isDump)
+	{
+		result = dump(&device, path);
+	}
+	else
+	{
+		wanted = device;
+		if(!load_file(path, &wanted))
+		{
+			result = 1;
+		}
+		else
+		{
+			unsigned changed = keymap_text_diff(stdout, &device, &wanted);
+
+			printf("%u bytes differ\n", changed);
+			if(strcmp(cmd, "verify") == 0)
+			{
+				result = changed != 0;
+			}
+			else if(strcmp(cmd, "upload") == 0 && changed != 0)
+			{
+				result = upload(dev, &wanted);
+			}
+		}
+	}
+	usbhidCloseDevice(dev);
+	return result;
+}
@@ -0,0 +1,684 @@
+/*
+ * keymapText.c
+ *
+ * Text form of KEYMAP_IMAGE for the configurator. One statement per line,
+ * '#' starts a comment, numbers take C syntax (12, 0x1c, 014):
+ *
+ *   layer <n>
+ *   button <1-6|enc> <mode> <action> [alt <action>]
+ *   encoder cw|ccw <action>
+ *   macro <id>
+ *   step <modifiers> <key> <delay_ms>
+ *   accel <interval_ms> <steps>
+ *
+ * <mode> is pressed, released, long, taphold or double (KEYBOARD_MAP_MDOE)
+ * and <action> one of
+ *
+ *   none | key <modifiers> <key> | macro <id> | consumer <usage>
+ *        | layer <n> | lock <n> | wheel <units> | pan <units>
+ *
+ * where a consumer <usage> is 16 bits, up to HID_CONSUMER_USAGE_MAX, or one
+ * of the names in consumerNames: play, pause, playpause, stop, record,
+ * rewind, forward, previous, next, mute, volup, voldown. wheel and pan
+ * are for the encoder only: each step scrolls by the signed <units>, in
+ * 1/MOUSE_WHEEL_MULTIPLIER of a detent once the host has switched the
+ * wheel to high resolution.
+ *
+ * button and encoder lines change the entry of the last 'layer' line and
+ * leave the rest of the image alone. macro and accel lines replace the
+ * whole macro area and acceleration curve instead, since entries there have
+ * no fixed place: macros must come in id order, each followed by its steps.
+ *
+ * Created: 17-Oct-26 7:04:15 PM
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "keymapText.h"
+#include "reportScheduler.h"
+#include "USB/usb_hid_consumer.h"
+
+#define TOKENS_MAX	12
+
+static const char *const modeNames[] = {
+	[ON_PRESSED]	= "pressed",
+	[ON_RELEASED]	= "released",
+	[LONG_PRESS]	= "long",
+	[TAP_HOLD]		= "taphold",
+	[DOUBLE_TAP]	= "double",
+};
+
+static const char *const buttonNames[BUTTON_COUNT] = {
+	[Button_1] = "1", [Button_2] = "2", [Button_3] = "3",
+	[Button_4] = "4", [Button_5] = "5", [Button_6] = "6",
+	[Button_ENC] = "enc",
+};
+
+// Transport and volume: media keys need no window focus on the host.
+static const struct
+{
+	const char *name;
+	uint16_t usage;
+} consumerNames[] = {
+	{ "play",		HID_CONSUMER_PLAY },
+	{ "pause",		HID_CONSUMER_PAUSE },
+	{ "playpause",	HID_CONSUMER_PLAY_PAUSE },
+	{ "stop",		HID_CONSUMER_STOP },
+	{ "record",		HID_CONSUMER_RECORD },
+	{ "rewind",		HID_CONSUMER_REWIND },
+	{ "forward",	HID_CONSUMER_FAST_FORWARD },
+	{ "previous",	HID_CONSUMER_SCAN_PREV_TRK },
+	{ "next",		HID_CONSUMER_SCAN_NEXT_TRK },
+	{ "mute",		HID_CONSUMER_MUTE },
+	{ "volup",		HID_CONSUMER_VOLUME_UP },
+	{ "voldown",	HID_CONSUMER_VOLUME_DOWN },
+};
+
+typedef struct
+{
+	const char *name;
+	unsigned line;
+	int layer;				// -1 until a 'layer' line
+	bool macrosSeen;
+	int macroId;			// last 'macro' line
+	size_t macroOffset;		// next free byte in image->macros
+	bool macroOpen;			// steps may follow, MACRO_END still due
+	unsigned accelCount;
+} PARSER;
+
+uint16_t keymap_image_crc(const KEYMAP_IMAGE *image)
+{
+	const uint8_t *data = (const uint8_t *)image->layers;
+	uint16_t crc = 0xFFFF;
+
+	// Same polynomial and bit order as avr-libc's _crc16_update().
+	for(size_t i = 0; i < sizeof(*image) - offsetof(KEYMAP_IMAGE, layers); i++)
+	{
+		crc ^= data[i];
+		for(int bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+		}
+	}
+	return crc;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Printing                                                                  */
+/* ------------------------------------------------------------------------- */
+
+static void print_action(FILE *f, const KEYBOARD_ACTION *action)
+{
+	switch(action->type)
+	{
+		case ACTION_KEY:
+			if(action->modifiers == 0 && action->hidCode == 0)
+			{
+				fprintf(f, "none");
+				break;
+			}
+			fprintf(f, "key 0x%02x 0x%02x", action->modifiers, action->hidCode);
+			break;
+		case ACTION_MACRO:
+			fprintf(f, "macro %u", action->hidCode);
+			break;
+		case ACTION_CONSUMER:
+			for(size_t i = 0; i < sizeof(consumerNames) / sizeof(consumerNames[0]); i++)
+			{
+				if(consumerNames[i].usage == KEYBOARD_ACTION_USAGE(action))
+				{
+					fprintf(f, "consumer %s", consumerNames[i].name);
+					return;
+				}
+			}
+			fprintf(f, "consumer 0x%02x", KEYBOARD_ACTION_USAGE(action));
+			break;
+		case ACTION_LAYER:
+			fprintf(f, "layer %u", action->hidCode);
+			break;
+		case ACTION_LAYER_LOCK:
+			fprintf(f, "lock %u", action->hidCode);
+			break;
+		case ACTION_WHEEL:
+			fprintf(f, "%s %d", action->hidCode == MOUSE_AXIS_PAN ? "pan" : "wheel", (int8_t)action->modifiers);
+			break;
+		default:
+			fprintf(f, "none");
+			break;
+	}
+}
+
+static bool mode_has_alt(uint8_t mode)
+{
+	return mode == LONG_PRESS || mode == TAP_HOLD || mode == DOUBLE_TAP;
+}
+
+static void print_button(FILE *f, uint8_t btn, const struct KEYBOARD_KEY *key)
+{
+	const char *mode = key->mode < sizeof(modeNames) / sizeof(modeNames[0]) ? modeNames[key->mode] : NULL;
+
+	fprintf(f, "button %s %s ", buttonNames[btn], mode ? mode : "pressed");
+	print_action(f, &key->action);
+	if(mode_has_alt(key->mode))
+	{
+		fprintf(f, " alt ");
+		print_action(f, &key->alt);
+	}
+	fprintf(f, "\n");
+}
+
+static void print_encoder(FILE *f, const char *direction, const KEYBOARD_ACTION *action)
+{
+	fprintf(f, "encoder %s ", direction);
+	print_action(f, action);
+	fprintf(f, "\n");
+}
+
+static bool is_macro_end(const uint8_t *step)
+{
+	return step[0] == 0 && step[1] == 0;
+}
+
+// Bytes of the macro area in use, up to and including the last MACRO_END
+// that is followed by nothing but zeros.
+static size_t macro_area_used(const uint8_t *macros)
+{
+	size_t used = KEYMAP_MACRO_BYTES;
+
+	while(used >= MACRO_STEP_SIZE && macros[used - 1] == 0 && macros[used - 2] == 0 && macros[used - 3] == 0)
+	{
+		used -= MACRO_STEP_SIZE;
+	}
+	if(used == 0 || used == KEYMAP_MACRO_BYTES)
+	{
+		return used;
+	}
+	return used + MACRO_STEP_SIZE;
+}
+
+static void print_macros(FILE *f, const char *prefix, const uint8_t *macros)
+{
+	size_t used = macro_area_used(macros);
+	unsigned id = 0;
+	bool start = true;
+
+	for(size_t offset = 0; offset + MACRO_STEP_SIZE <= used; offset += MACRO_STEP_SIZE)
+	{
+		const uint8_t *step = &macros[offset];
+
+		if(start)
+		{
+			fprintf(f, "%smacro %u\n", prefix, id++);
+			start = false;
+		}
+		if(is_macro_end(step))
+		{
+			start = true;
+			continue;
+		}
+		fprintf(f, "%sstep 0x%02x 0x%02x %u\n", prefix, step[0], step[1], step[2]);
+	}
+}
+
+static void print_accel(FILE *f, const char *prefix, const struct ENCODER_ACCEL_POINT *curve)
+{
+	for(unsigned i = 0; i < ENCODER_ACCEL_POINTS && curve[i].steps != 0; i++)
+	{
+		fprintf(f, "%saccel %u %u\n", prefix, curve[i].interval, curve[i].steps);
+	}
+}
+
+void keymap_text_print(FILE *f, const KEYMAP_IMAGE *image)
+{
+	fprintf(f, "# CubaseRemote keymap, version %u\n", image->version);
+	for(uint8_t layer = 0; layer < KEYBOARD_LAYER_COUNT; layer++)
+	{
+		const KEYBOARD_LAYER *l = &image->layers[layer];
+
+		fprintf(f, "\nlayer %u\n", layer);
+		for(uint8_t btn = 0; btn < BUTTON_COUNT; btn++)
+		{
+			print_button(f, btn, &l->keys[btn]);
+		}
+		print_encoder(f, "cw", &l->encoderCw);
+		print_encoder(f, "ccw", &l->encoderCcw);
+	}
+	fprintf(f, "\n");
+	print_macros(f, "", image->macros);
+	fprintf(f, "\n");
+	print_accel(f, "", image->accelCurve);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Diff                                                                      */
+/* ------------------------------------------------------------------------- */
+
+static unsigned count_differences(const void *a, const void *b, size_t len)
+{
+	unsigned count = 0;
+
+	for(size_t i = 0; i < len; i++)
+	{
+		count += ((const uint8_t *)a)[i] != ((const uint8_t *)b)[i];
+	}
+	return count;
+}
+
+unsigned keymap_text_diff(FILE *f, const KEYMAP_IMAGE *from, const KEYMAP_IMAGE *to)
+{
+	for(uint8_t layer = 0; layer < KEYBOARD_LAYER_COUNT; layer++)
+	{
+		const KEYBOARD_LAYER *a = &from->layers[layer];
+		const KEYBOARD_LAYER *b = &to->layers[layer];
+
+		for(uint8_t btn = 0; btn < BUTTON_COUNT; btn++)
+		{
+			if(memcmp(&a->keys[btn], &b->keys[btn], sizeof(a->keys[btn])) != 0)
+			{
+				fprintf(f, "- layer %u ", layer);
+				print_button(f, btn, &a->keys[btn]);
+				fprintf(f, "+ layer %u ", layer);
+				print_button(f, btn, &b->keys[btn]);
+			}
+		}
+		if(memcmp(&a->encoderCw, &b->encoderCw, sizeof(a->encoderCw)) != 0)
+		{
+			fprintf(f, "- layer %u ", layer);
+			print_encoder(f, "cw", &a->encoderCw);
+			fprintf(f, "+ layer %u ", layer);
+			print_encoder(f, "cw", &b->encoderCw);
+		}
+		if(memcmp(&a->encoderCcw, &b->encoderCcw, sizeof(a->encoderCcw)) != 0)
+		{
+			fprintf(f, "- layer %u ", layer);
+			print_encoder(f, "ccw", &a->encoderCcw);
+			fprintf(f, "+ layer %u ", layer);
+			print_encoder(f, "ccw", &b->encoderCcw);
+		}
+	}
+	if(memcmp(from->macros, to->macros, sizeof(from->macros)) != 0)
+	{
+		print_macros(f, "- ", from->macros);
+		print_macros(f, "+ ", to->macros);
+	}
+	if(memcmp(from->accelCurve, to->accelCurve, sizeof(from->accelCurve)) != 0)
+	{
+		print_accel(f, "- ", from->accelCurve);
+		print_accel(f, "+ ", to->accelCurve);
+	}
+	return count_differences(from, to, sizeof(*from));
+}
+
+/* ------------------------------------------------------------------------- */
+/* Parsing                                                                   */
+/* ------------------------------------------------------------------------- */
+
+static bool parse_error(const PARSER *p, const char *what, const char *token)
+{
+	fprintf(stderr, "%s:%u: %s%s%s\n", p->name, p->line, what, token ? ": " : "", token ? token : "");
+	return false;
+}
+
+static bool parse_number(const PARSER *p, const char *token, long min, long max, long *value)
+{
+	char *end;
+
+	if(token == NULL)
+	{
+		return parse_error(p, "missing number", NULL);
+	}
+	*value = strtol(token, &end, 0);
+	if(*end != 0 || end == token)
+	{
+		return parse_error(p, "not a number", token);
+	}
+	if(*value < min || *value > max)
+	{
+		return parse_error(p, "out of range", token);
+	}
+	return true;
+}
+
+// Reads one action starting at tokens[*pos] and advances *pos past it.
+static bool parse_action(const PARSER *p, char **tokens, int count, int *pos, KEYBOARD_ACTION *action)
+{
+	const char *kind = *pos < count ? tokens[(*pos)++] : NULL;
+	long a = 0, b = 0;
+
+	#define NEXT	(*pos < count ? tokens[(*pos)++] : NULL)
+	if(kind == NULL)
+	{
+		return parse_error(p, "missing action", NULL);
+	}
+	memset(action, 0, sizeof(*action));
+	if(strcmp(kind, "none") == 0)
+	{
+		action->type = ACTION_KEY;
+		return true;
+	}
+	if(strcmp(kind, "key") == 0)
+	{
+		if(!parse_number(p, NEXT, 0, 0xFF, &a) || !parse_number(p, NEXT, 0, 0xFF, &b))
+		{
+			return false;
+		}
+		*action = (KEYBOARD_ACTION){ ACTION_KEY, (uint8_t)a, (uint8_t)b };
+		return true;
+	}
+	if(strcmp(kind, "macro") == 0)
+	{
+		if(!parse_number(p, NEXT, 0, 0xFF, &a))
+		{
+			return false;
+		}
+		*action = (KEYBOARD_ACTION){ ACTION_MACRO, 0, (uint8_t)a };
+		return true;
+	}
+	if(strcmp(kind, "consumer") == 0)
+	{
+		const char *usage = NEXT;
+		size_t i;
+
+		for(i = 0; i < sizeof(consumerNames) / sizeof(consumerNames[0]); i++)
+		{
+			if(usage != NULL && strcmp(usage, consumerNames[i].name) == 0)
+			{
+				a = consumerNames[i].usage;
+				break;
+			}
+		}
+		if(i == sizeof(consumerNames) / sizeof(consumerNames[0])
+			&& !parse_number(p, usage, 0, HID_CONSUMER_USAGE_MAX, &a))
+		{
+			return false;
+		}
+		*action = (KEYBOARD_ACTION)KEYBOARD_CONSUMER_ACTION(a);
+		return true;
+	}
+	if(strcmp(kind, "wheel") == 0 || strcmp(kind, "pan") == 0)
+	{
+		if(!parse_number(p, NEXT, -INT8_MAX, INT8_MAX, &a))
+		{
+			return false;
+		}
+		*action = (KEYBOARD_ACTION){ ACTION_WHEEL, (uint8_t)(int8_t)a, kind[0] == 'w' ? MOUSE_AXIS_WHEEL : MOUSE_AXIS_PAN };
+		return true;
+	}
+	if(strcmp(kind, "layer") == 0 || strcmp(kind, "lock") == 0)
+	{
+		if(!parse_number(p, NEXT, 0, KEYBOARD_LAYER_COUNT - 1, &a))
+		{
+			return false;
+		}
+		*action = (KEYBOARD_ACTION){ kind[1] == 'a' ? ACTION_LAYER : ACTION_LAYER_LOCK, 0, (uint8_t)a };
+		return true;
+	}
+	#undef NEXT
+	return parse_error(p, "unknown action", kind);
+}
+
+static bool parse_button(PARSER *p, char **tokens, int count, KEYMAP_IMAGE *image)
+{
+	struct KEYBOARD_KEY key = { 0 };
+	int btn = -1, pos = 3;
+
+	if(count < 4)
+	{
+		return parse_error(p, "usage: button <1-6|enc> <mode> <action> [alt <action>]", NULL);
+	}
+	if(p->layer < 0)
+	{
+		return parse_error(p, "button before any layer line", NULL);
+	}
+	for(int i = 0; i < BUTTON_COUNT; i++)
+	{
+		if(strcmp(tokens[1], buttonNames[i]) == 0)
+		{
+			btn = i;
+		}
+	}
+	if(btn < 0)
+	{
+		return parse_error(p, "unknown button", tokens[1]);
+	}
+	for(size_t i = 0; i < sizeof(modeNames) / sizeof(modeNames[0]); i++)
+	{
+		if(modeNames[i] && strcmp(tokens[2], modeNames[i]) == 0)
+		{
+			key.mode = (uint8_t)i;
+		}
+	}
+	if(key.mode == 0)
+	{
+		return parse_error(p, "unknown mode", tokens[2]);
+	}
+	if(!parse_action(p, tokens, count, &pos, &key.action))
+	{
+		return false;
+	}
+	if(pos < count && strcmp(tokens[pos], "alt") == 0)
+	{
+		pos++;
+		if(!mode_has_alt(key.mode))
+		{
+			return parse_error(p, "mode has no alt action", tokens[2]);
+		}
+		if(!parse_action(p, tokens, count, &pos, &key.alt))
+		{
+			return false;
+		}
+	}
+	if(key.action.type == ACTION_WHEEL || key.alt.type == ACTION_WHEEL)
+	{
+		return parse_error(p, "wheel and pan are for the encoder only", NULL);
+	}
+	if(pos < count)
+	{
+		return parse_error(p, "unexpected", tokens[pos]);
+	}
+	image->layers[p->layer].keys[btn] = key;
+	return true;
+}
+
+static bool parse_encoder(PARSER *p, char **tokens, int count, KEYMAP_IMAGE *image)
+{
+	KEYBOARD_ACTION action;
+	int pos = 2;
+
+	if(count < 3 || (strcmp(tokens[1], "cw") != 0 && strcmp(tokens[1], "ccw") != 0))
+	{
+		return parse_error(p, "usage: encoder cw|ccw <action>", NULL);
+	}
+	if(p->layer < 0)
+	{
+		return parse_error(p, "encoder before any layer line", NULL);
+	}
+	if(!parse_action(p, tokens, count, &pos, &action))
+	{
+		return false;
+	}
+	if(action.type != ACTION_KEY && action.type != ACTION_CONSUMER && action.type != ACTION_WHEEL)
+	{
+		return parse_error(p, "the encoder takes key, consumer or wheel actions only", NULL);
+	}
+	if(pos < count)
+	{
+		return parse_error(p, "unexpected", tokens[pos]);
+	}
+	if(tokens[1][1] == 'w')
+	{
+		image->layers[p->layer].encoderCw = action;
+	}
+	else
+	{
+		image->layers[p->layer].encoderCcw = action;
+	}
+	return true;
+}
+
+static bool put_macro_step(PARSER *p, KEYMAP_IMAGE *image, uint8_t modifiers, uint8_t key, uint8_t delay)
+{
+	if(p->macroOffset + MACRO_STEP_SIZE > KEYMAP_MACRO_BYTES)
+	{
+		return parse_error(p, "macro area full", NULL);
+	}
+	image->macros[p->macroOffset++] = modifiers;
+	image->macros[p->macroOffset++] = key;
+	image->macros[p->macroOffset++] = delay;
+	return true;
+}
+
+static bool close_macro(PARSER *p, KEYMAP_IMAGE *image)
+{
+	if(!p->macroOpen)
+	{
+		return true;
+	}
+	p->macroOpen = false;
+	return put_macro_step(p, image, 0, 0, 0);
+}
+
+static bool parse_macro(PARSER *p, char **tokens, int count, KEYMAP_IMAGE *image)
+{
+	long id;
+
+	if(count != 2 || !parse_number(p, tokens[1], 0, 0xFF, &id))
+	{
+		return parse_error(p, "usage: macro <id>", NULL);
+	}
+	if(!p->macrosSeen)
+	{
+		p->macrosSeen = true;
+		memset(image->macros, 0, sizeof(image->macros));
+	}
+	if(id != p->macroId + 1)
+	{
+		return parse_error(p, "macros must be numbered 0, 1, 2, ... in order", tokens[1]);
+	}
+	if(!close_macro(p, image))
+	{
+		return false;
+	}
+	p->macroId = (int)id;
+	p->macroOpen = true;
+	return true;
+}
+
+static bool parse_step(PARSER *p, char **tokens, int count, KEYMAP_IMAGE *image)
+{
+	long modifiers, key, delay;
+
+	if(count != 4)
+	{
+		return parse_error(p, "usage: step <modifiers> <key> <delay_ms>", NULL);
+	}
+	if(!p->macroOpen)
+	{
+		return parse_error(p, "step outside a macro", NULL);
+	}
+	if(!parse_number(p, tokens[1], 0, 0xFF, &modifiers) || !parse_number(p, tokens[2], 0, 0xFF, &key)
+		|| !parse_number(p, tokens[3], 0, 0xFF, &delay))
+	{
+		return false;
+	}
+	if(modifiers == 0 && key == 0)
+	{
+		return parse_error(p, "a step must press something", NULL);
+	}
+	return put_macro_step(p, image, (uint8_t)modifiers, (uint8_t)key, (uint8_t)delay);
+}
+
+static bool parse_accel(PARSER *p, char **tokens, int count, KEYMAP_IMAGE *image)
+{
+	long interval, steps;
+
+	if(count != 3)
+	{
+		return parse_error(p, "usage: accel <interval_ms> <steps>", NULL);
+	}
+	if(!parse_number(p, tokens[1], 0, 0xFF, &interval) || !parse_number(p, tokens[2], 1, INT8_MAX, &steps))
+	{
+		return false;
+	}
+	if(p->accelCount == 0)
+	{
+		memset(image->accelCurve, 0, sizeof(image->accelCurve));
+	}
+	if(p->accelCount == ENCODER_ACCEL_POINTS)
+	{
+		return parse_error(p, "too many accel points", NULL);
+	}
+	image->accelCurve[p->accelCount++] = (struct ENCODER_ACCEL_POINT){ (uint8_t)interval, (uint8_t)steps };
+	return true;
+}
+
+bool keymap_text_parse(FILE *f, const char *name, KEYMAP_IMAGE *image)
+{
+	PARSER p = { .name = name, .layer = -1, .macroId = -1 };
+	char line[256];
+
+	while(fgets(line, sizeof(line), f))
+	{
+		char *tokens[TOKENS_MAX];
+		int count = 0;
+		char *hash = strchr(line, '#');
+		bool ok;
+
+		p.line++;
+		if(hash)
+		{
+			*hash = 0;
+		}
+		for(char *t = strtok(line, " \t\r\n"); t; t = strtok(NULL, " \t\r\n"))
+		{
+			if(count == TOKENS_MAX)
+			{
+				return parse_error(&p, "line too long", NULL);
+			}
+			tokens[count++] = t;
+		}
+		if(count == 0)
+		{
+			continue;
+		}
+
+		if(strcmp(tokens[0], "layer") == 0)
+		{
+			long layer;
+			ok = count == 2 ? parse_number(&p, tokens[1], 0, KEYBOARD_LAYER_COUNT - 1, &layer)
+				: parse_error(&p, "usage: layer <n>", NULL);
+			p.layer = ok ? (int)layer : p.layer;
+		}
+		else if(strcmp(tokens[0], "button") == 0)
+		{
+			ok = parse_button(&p, tokens, count, image);
+		}
+		else if(strcmp(tokens[0], "encoder") == 0)
+		{
+			ok = parse_encoder(&p, tokens, count, image);
+		}
+		else if(strcmp(tokens[0], "macro") == 0)
+		{
+			ok = parse_macro(&p, tokens, count, image);
+		}
+		else if(strcmp(tokens[0], "step") == 0)
+		{
+			ok = parse_step(&p, tokens, count, image);
+		}
+		else if(strcmp(tokens[0], "accel") == 0)
+		{
+			ok = parse_accel(&p, tokens, count, image);
+		}
+		else
+		{
+			ok = parse_error(&p, "unknown statement", tokens[0]);
+		}
+		if(!ok)
+		{
+			return false;
+		}
+	}
+	return close_macro(&p, image);
+}
@@ -0,0 +1,32 @@
+/*
+ * keymapText.h
+ *
+ * Text form of the keymap feature report, see keymapText.c.
+ *
+ * Created: 17-Oct-26 7:02:41 PM
+ */
+
+
+#ifndef KEYMAPTEXT_H_
+#define KEYMAPTEXT_H_
+
+#include <stdio.h>
+
+#include "keymap.h"
+
+// Writes the whole image; parsing the output gives the same image back.
+void keymap_text_print(FILE *f, const KEYMAP_IMAGE *image);
+
+// Applies the statements in 'f' on top of 'image'. Returns false, with a
+// message on stderr, on the first error; 'image' is then half edited.
+bool keymap_text_parse(FILE *f, const char *name, KEYMAP_IMAGE *image);
+
+// Prints every entry that differs, '-' for 'from' and '+' for 'to'.
+// Returns the number of bytes that differ.
+unsigned keymap_text_diff(FILE *f, const KEYMAP_IMAGE *from, const KEYMAP_IMAGE *to);
+
+// CRC over everything after the crc field, as keymap.c checks it.
+uint16_t keymap_image_crc(const KEYMAP_IMAGE *image);
+
+
+#endif /* KEYMAPTEXT_H_ */
@@ -0,0 +1,229 @@
+/*
+ * simDevice.c
+ *
+ * hiddata.h on top of the host simulation instead of libusb, so the
+ * configurator can be run and tested without the hardware. The firmware
+ * runs in its own thread on the simulator's virtual clock and only moves
+ * while it has something to do: a feature report transfer or an EEPROM
+ * write in flight. The EEPROM is kept in the file named by
+ * CUBASEREMOTE_SIM_EEPROM, so settings survive from one run to the next
+ * the way they do on the device.
+ *
+ * Created: 17-Oct-26 7:31:50 PM
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hiddata.h"
+#include "simulator.h"
+#include "usbconfig.h"
+#include "usbdrv.h"
+#include "eepromWriter.h"
+#include "avr/eeprom.h"
+
+#define HID_REPORT_FEATURE	3		// GET/SET_REPORT wValue high byte
+#define TRANSFER_MAX		256		// the simulator's control buffer
+
+enum REQUEST_STATE
+{
+	REQUEST_NONE,
+	REQUEST_QUEUED,			// waiting for the firmware thread to pick it up
+	REQUEST_RUNNING,
+	REQUEST_DONE,
+};
+
+struct usbDevice
+{
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+	const char *eepromPath;
+	bool closing;
+
+	uint8_t state;			// REQUEST_STATE
+	bool in;				// GET_REPORT, else SET_REPORT
+	uint8_t reportId;
+	uint8_t data[TRANSFER_MAX];
+	uint16_t len;
+	bool ok;
+};
+
+static bool sim_is_busy(void)
+{
+	return eepromWriter_get_pending() != 0 || !eeprom_is_ready();
+}
+
+/* Runs on the firmware thread, from inside sim_run(). */
+static uint64_t next_stimulus(void *ctx)
+{
+	usbDevice_t *dev = ctx;
+	uint64_t next = SIM_NEVER;
+
+	pthread_mutex_lock(&dev->lock);
+	for(;;)
+	{
+		if(dev->state == REQUEST_QUEUED)
+		{
+			next = sim_now_ns();
+			break;
+		}
+		if(dev->state == REQUEST_RUNNING || sim_is_busy())
+		{
+			break;
+		}
+		if(dev->closing)
+		{
+			sim_stop();
+			break;
+		}
+		// Nothing to do: hold the virtual clock until the host asks.
+		pthread_cond_wait(&dev->changed, &dev->lock);
+	}
+	pthread_mutex_unlock(&dev->lock);
+	return next;
+}
+
+static void apply_stimulus(void *ctx, uint64_t now)
+{
+	usbDevice_t *dev = ctx;
+	uint16_t wValue;
+
+	(void)now;
+	pthread_mutex_lock(&dev->lock);
+	wValue = HID_REPORT_FEATURE << 8 | dev->reportId;
+	dev->state = REQUEST_RUNNING;
+	if(dev->in)
+	{
+		sim_control_read(USBRQ_TYPE_CLASS | USBRQ_RCPT_INTERFACE | USBRQ_DIR_DEVICE_TO_HOST,
+			USBRQ_HID_GET_REPORT, wValue, 0, dev->len);
+	}
+	else
+	{
+		sim_control_write(USBRQ_TYPE_CLASS | USBRQ_RCPT_INTERFACE | USBRQ_DIR_HOST_TO_DEVICE,
+			USBRQ_HID_SET_REPORT, wValue, 0, dev->data, dev->len);
+	}
+	pthread_mutex_unlock(&dev->lock);
+}
+
+static void on_control(void *ctx, uint64_t now, bool ok, const uint8_t *data, uint16_t len)
+{
+	usbDevice_t *dev = ctx;
+
+	(void)now;
+	pthread_mutex_lock(&dev->lock);
+	if(dev->in)
+	{
+		memcpy(dev->data, data, len);
+		dev->len = len;
+	}
+	dev->ok = ok;
+	dev->state = REQUEST_DONE;
+	pthread_cond_broadcast(&dev->changed);
+	pthread_mutex_unlock(&dev->lock);
+}
+
+static void *firmware_thread(void *arg)
+{
+	usbDevice_t *dev = arg;
+	SIM_CONFIG config =
+	{
+		.loop_ns = 25000,
+		.poll_interval_ns = USB_CFG_INTR_POLL_INTERVAL * 1000000UL,
+		.end_ns = SIM_NEVER,
+		.next_stimulus = next_stimulus,
+		.apply_stimulus = apply_stimulus,
+		.control = on_control,
+		.ctx = dev,
+	};
+
+	sim_init(&config);
+	if(dev->eepromPath && !sim_eeprom_load(dev->eepromPath))
+	{
+		perror(dev->eepromPath);
+	}
+	sim_run();
+	if(dev->eepromPath && !sim_eeprom_save(dev->eepromPath))
+	{
+		perror(dev->eepromPath);
+	}
+	return NULL;
+}
+
+int usbhidOpenDevice(usbDevice_t **device, int vendorID, char *vendorName, int productID, char *productName, int usesReportIDs)
+{
+	usbDevice_t *dev = calloc(1, sizeof(*dev));
+
+	(void)vendorID; (void)vendorName; (void)productID; (void)productName; (void)usesReportIDs;
+	if(dev == NULL)
+	{
+		return USBOPEN_ERR_IO;
+	}
+	pthread_mutex_init(&dev->lock, NULL);
+	pthread_cond_init(&dev->changed, NULL);
+	dev->eepromPath = getenv("CUBASEREMOTE_SIM_EEPROM");
+	if(pthread_create(&dev->thread, NULL, firmware_thread, dev) != 0)
+	{
+		free(dev);
+		return USBOPEN_ERR_IO;
+	}
+	*device = dev;
+	return USBOPEN_SUCCESS;
+}
+
+/* Lets the firmware finish pending EEPROM writes, as a device left plugged
+ * in would, then saves the EEPROM. */
+void usbhidCloseDevice(usbDevice_t *device)
+{
+	pthread_mutex_lock(&device->lock);
+	device->closing = true;
+	pthread_cond_broadcast(&device->changed);
+	pthread_mutex_unlock(&device->lock);
+	pthread_join(device->thread, NULL);
+	pthread_cond_destroy(&device->changed);
+	pthread_mutex_destroy(&device->lock);
+	free(device);
+}
+
+static bool sim_transfer(usbDevice_t *dev)
+{
+	pthread_mutex_lock(&dev->lock);
+	dev->state = REQUEST_QUEUED;
+	pthread_cond_broadcast(&dev->changed);
+	while(dev->state != REQUEST_DONE)
+	{
+		pthread_cond_wait(&dev->changed, &dev->lock);
+	}
+	dev->state = REQUEST_NONE;
+	pthread_mutex_unlock(&dev->lock);
+	return dev->ok;
+}
+
+int usbhidSetReport(usbDevice_t *device, char *buffer, int len)
+{
+	if(len <= 0 || len > TRANSFER_MAX)
+	{
+		return USBOPEN_ERR_IO;
+	}
+	device->in = false;
+	device->reportId = (uint8_t)buffer[0];
+	device->len = (uint16_t)len;
+	memcpy(device->data, buffer, (size_t)len);
+	return sim_transfer(device) ? USBOPEN_SUCCESS : USBOPEN_ERR_IO;
+}
+
+int usbhidGetReport(usbDevice_t *device, int reportID, char *buffer, int *len)
+{
+	device->in = true;
+	device->reportId = (uint8_t)reportID;
+	device->len = (uint16_t)(*len < TRANSFER_MAX ? *len : TRANSFER_MAX);
+	if(!sim_transfer(device))
+	{
+		return USBOPEN_ERR_IO;
+	}
+	memcpy(buffer, device->data, device->len);
+	*len = device->len;
+	return USBOPEN_SUCCESS;
+}
@@ -0,0 +1,30 @@
+/*
+ * avr/eeprom.h
+ *
+ * Host stand-in for avr-libc's EEPROM accessors. EEMEM variables are
+ * collected in their own section, which simulator.c treats as the EEPROM:
+ * erased to 0xFF at start-up and written with the ATmega8A's write time,
+ * so a write issued while the previous one is running busy-waits.
+ *
+ * Created: 17-Oct-26 5:32:18 PM
+ */ 
+
+
+#ifndef SIM_AVR_EEPROM_H_
+#define SIM_AVR_EEPROM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define EEMEM	__attribute__((section("sim_eeprom")))
+
+int eeprom_is_ready(void);
+#define eeprom_busy_wait()	do {} while(!eeprom_is_ready())
+
+uint8_t eeprom_read_byte(const uint8_t *addr);
+void eeprom_read_block(void *dst, const void *src, size_t n);
+
+void eeprom_write_byte(uint8_t *addr, uint8_t value);
+void eeprom_update_byte(uint8_t *addr, uint8_t value);
+
+#endif /* SIM_AVR_EEPROM_H_ */
@@ -0,0 +1,26 @@
+/*
+ * avr/interrupt.h
+ *
+ * Host stand-in for avr-libc's interrupt helpers. An ISR becomes a plain
+ * function named after its vector, and the simulator calls it when the
+ * emulated peripheral fires and SREG_I is set.
+ *
+ * Created: 17-Oct-26 9:14:02 AM
+ */ 
+
+
+#ifndef SIM_AVR_INTERRUPT_H_
+#define SIM_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+
+#define ISR(vector, ...)	void vector(void); void vector(void)
+
+#define sei()	(SREG |= (1 << SREG_I))
+#define cli()	(SREG &= ~(1 << SREG_I))
+
+#endif /* SIM_AVR_INTERRUPT_H_ */
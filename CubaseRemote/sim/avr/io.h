@@ -0,0 +1,138 @@
+/*
+ * avr/io.h
+ *
+ * Host stand-in for the ATmega8A register file. Every register the
+ * firmware touches is a plain variable owned by simulator.c, so the
+ * simulator can drive the input pins and read back the timer setup.
+ * TCNT1 is the exception: it counts with the virtual clock, so it is
+ * computed when read.
+ *
+ * Created: 17-Oct-26 9:12:40 AM
+ */ 
+
+
+#ifndef SIM_AVR_IO_H_
+#define SIM_AVR_IO_H_
+
+#include <stdint.h>
+
+extern volatile uint8_t SREG;
+
+extern volatile uint8_t PINB, DDRB, PORTB;
+extern volatile uint8_t PINC, DDRC, PORTC;
+extern volatile uint8_t PIND, DDRD, PORTD;
+
+extern volatile uint8_t TCCR1A, TCCR1B;
+uint16_t sim_read_tcnt1(void);
+#define TCNT1	(sim_read_tcnt1())
+
+extern volatile uint8_t TCCR2, OCR2, TCNT2;
+extern volatile uint8_t TIMSK, TIFR;
+
+/* SREG */
+#define SREG_I	7
+
+/* PINB / DDRB / PORTB */
+#define PINB0	0
+#define PINB1	1
+#define PINB2	2
+#define PINB3	3
+#define PINB4	4
+#define PINB5	5
+#define PINB6	6
+#define PINB7	7
+#define DDRB0	0
+#define DDRB1	1
+#define DDRB2	2
+#define DDRB3	3
+#define DDRB4	4
+#define DDRB5	5
+#define DDRB6	6
+#define DDRB7	7
+#define PORTB0	0
+#define PORTB1	1
+#define PORTB2	2
+#define PORTB3	3
+#define PORTB4	4
+#define PORTB5	5
+#define PORTB6	6
+#define PORTB7	7
+
+/* PINC / DDRC / PORTC */
+#define PINC0	0
+#define PINC1	1
+#define PINC2	2
+#define PINC3	3
+#define PINC4	4
+#define PINC5	5
+#define PINC6	6
+#define DDRC0	0
+#define DDRC1	1
+#define DDRC2	2
+#define DDRC3	3
+#define DDRC4	4
+#define DDRC5	5
+#define DDRC6	6
+#define PORTC0	0
+#define PORTC1	1
+#define PORTC2	2
+#define PORTC3	3
+#define PORTC4	4
+#define PORTC5	5
+#define PORTC6	6
+
+/* PIND / DDRD / PORTD */
+#define PIND0	0
+#define PIND1	1
+#define PIND2	2
+#define PIND3	3
+#define PIND4	4
+#define PIND5	5
+#define PIND6	6
+#define PIND7	7
+#define DDRD0	0
+#define DDRD1	1
+#define DDRD2	2
+#define DDRD3	3
+#define DDRD4	4
+#define DDRD5	5
+#define DDRD6	6
+#define DDRD7	7
+#define PORTD0	0
+#define PORTD1	1
+#define PORTD2	2
+#define PORTD3	3
+#define PORTD4	4
+#define PORTD5	5
+#define PORTD6	6
+#define PORTD7	7
+
+/* TCCR1B */
+#define CS12	2
+#define CS11	1
+#define CS10	0
+
+/* TCCR2 */
+#define FOC2	7
+#define WGM20	6
+#define COM21	5
+#define COM20	4
+#define WGM21	3
+#define CS22	2
+#define CS21	1
+#define CS20	0
+
+/* TIMSK */
+#define OCIE2	7
+#define TOIE2	6
+#define TICIE1	5
+#define OCIE1A	4
+#define OCIE1B	3
+#define TOIE1	2
+#define TOIE0	0
+
+/* TIFR */
+#define OCF2	7
+#define TOV2	6
+
+#endif /* SIM_AVR_IO_H_ */
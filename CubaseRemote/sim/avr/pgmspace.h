@@ -0,0 +1,24 @@
+/*
+ * avr/pgmspace.h
+ *
+ * Host stand-in for avr-libc's flash accessors. The host has a single
+ * address space, so PROGMEM data is ordinary const data.
+ *
+ * Created: 17-Oct-26 9:15:31 AM
+ */ 
+
+
+#ifndef SIM_AVR_PGMSPACE_H_
+#define SIM_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s)	(s)
+
+#define pgm_read_byte(addr)		(*(const uint8_t *)(addr))
+#define pgm_read_word(addr)		(*(const uint16_t *)(addr))
+#define memcpy_P(dst, src, len)	memcpy((dst), (src), (len))
+
+#endif /* SIM_AVR_PGMSPACE_H_ */
@@ -0,0 +1,214 @@
+/*
+ * hidDecoder.c
+ *
+ * Created: 17-Oct-26 10:11:47 AM
+ */ 
+
+#include <string.h>
+
+#include "hidDecoder.h"
+
+#define ITEM_TYPE_MAIN		0
+#define ITEM_TYPE_GLOBAL	1
+#define ITEM_TYPE_LOCAL		2
+
+#define MAIN_INPUT			0x8
+#define GLOBAL_USAGE_PAGE	0x0
+#define GLOBAL_LOGICAL_MIN	0x1
+#define GLOBAL_REPORT_SIZE	0x7
+#define GLOBAL_REPORT_ID	0x8
+#define GLOBAL_REPORT_COUNT	0x9
+#define LOCAL_USAGE			0x0
+#define LOCAL_USAGE_MIN		0x1
+#define LOCAL_USAGE_MAX		0x2
+
+static uint32_t hid_full_usage(uint32_t data, uint8_t size, uint16_t page)
+{
+	return size == 4 ? data : HID_USAGE(page, data);
+}
+
+bool hid_parse_descriptor(const uint8_t *descriptor, uint16_t length, HID_LAYOUT *layout)
+{
+	uint16_t page = 0;
+	int32_t logical_min = 0;
+	uint8_t report_size = 0, report_count = 0, report_id = 0;
+	uint32_t usage_min = 0, usage_max = 0;
+	uint8_t usage_count = 0;
+	uint16_t offsets[256];
+
+	memset(layout, 0, sizeof(*layout));
+	memset(offsets, 0, sizeof(offsets));
+
+	for(uint16_t i = 0; i < length;)
+	{
+		uint8_t prefix = descriptor[i++];
+		uint8_t size = prefix & 0x03;
+		uint8_t type = (prefix >> 2) & 0x03;
+		uint8_t tag = prefix >> 4;
+		uint32_t data = 0;
+
+		if(prefix == 0xFE)
+		{
+			return false;		// long items are not used by this device
+		}
+		if(size == 3)
+		{
+			size = 4;
+		}
+		if(i + size > length)
+		{
+			return false;
+		}
+		for(uint8_t b = 0; b < size; b++)
+		{
+			data |= (uint32_t)descriptor[i + b] << (8 * b);
+		}
+		i += size;
+
+		if(type == ITEM_TYPE_GLOBAL)
+		{
+			switch(tag)
+			{
+				case GLOBAL_USAGE_PAGE:		page = (uint16_t)data; break;
+				case GLOBAL_LOGICAL_MIN:
+					logical_min = (int32_t)data;
+					if(size > 0 && size < 4 && (data & (1UL << (8 * size - 1))))
+					{
+						logical_min -= (int32_t)(1UL << (8 * size));
+					}
+					break;
+				case GLOBAL_REPORT_SIZE:	report_size = (uint8_t)data; break;
+				case GLOBAL_REPORT_ID:		report_id = (uint8_t)data; layout->uses_report_ids = true; break;
+				case GLOBAL_REPORT_COUNT:	report_count = (uint8_t)data; break;
+				default: break;
+			}
+		}
+		else if(type == ITEM_TYPE_LOCAL)
+		{
+			uint32_t usage = hid_full_usage(data, size, page);
+			switch(tag)
+			{
+				case LOCAL_USAGE:
+					if(usage_count++ == 0)
+					{
+						usage_min = usage;
+					}
+					usage_max = usage;
+					break;
+				case LOCAL_USAGE_MIN:	usage_min = usage; usage_count = 1; break;
+				case LOCAL_USAGE_MAX:	usage_max = usage; break;
+				default: break;
+			}
+		}
+		else if(type == ITEM_TYPE_MAIN)
+		{
+			if(tag == MAIN_INPUT && layout->field_count < HID_MAX_FIELDS)
+			{
+				HID_FIELD *field = &layout->fields[layout->field_count++];
+				field->report_id = report_id;
+				field->flags = (uint8_t)data;
+				field->bit_offset = offsets[report_id];
+				field->size = report_size;
+				field->count = report_count;
+				field->logical_min = logical_min;
+				field->usage_min = usage_min;
+				field->usage_max = usage_max;
+				offsets[report_id] += (uint16_t)report_size * report_count;
+			}
+			usage_min = usage_max = 0;
+			usage_count = 0;
+		}
+	}
+	return true;
+}
+
+static int32_t hid_extract(const uint8_t *data, uint8_t length, uint16_t bit, uint8_t size, bool is_signed)
+{
+	uint32_t value = 0;
+
+	for(uint8_t b = 0; b < size; b++, bit++)
+	{
+		if((bit >> 3) < length && (data[bit >> 3] & (1 << (bit & 7))))
+		{
+			value |= 1UL << b;
+		}
+	}
+	if(is_signed && size < 32 && (value & (1UL << (size - 1))))
+	{
+		return (int32_t)value - (int32_t)(1UL << size);
+	}
+	return (int32_t)value;
+}
+
+uint8_t hid_decode_input(const HID_LAYOUT *layout, const uint8_t *report, uint8_t length,
+	uint8_t *report_id, HID_USAGE_VALUE *out, uint8_t max)
+{
+	uint8_t id = 0;
+	uint8_t n = 0;
+
+	if(layout->uses_report_ids)
+	{
+		if(length == 0)
+		{
+			return 0;
+		}
+		id = *report++;
+		length--;
+	}
+	*report_id = id;
+
+	for(uint8_t f = 0; f < layout->field_count; f++)
+	{
+		const HID_FIELD *field = &layout->fields[f];
+		bool variable = (field->flags & 0x02) != 0;
+
+		if(field->report_id != id || (field->flags & 0x01))
+		{
+			continue;		// other report, or constant padding
+		}
+		for(uint8_t i = 0; i < field->count && n < max; i++)
+		{
+			int32_t value = hid_extract(report, length, (uint16_t)(field->bit_offset + i * field->size),
+				field->size, field->logical_min < 0);
+
+			if(variable)
+			{
+				uint32_t usage = field->usage_min + i;
+				if(usage > field->usage_max)
+				{
+					usage = field->usage_max;
+				}
+				if(value != 0)
+				{
+					out[n].usage = usage;
+					out[n].value = value;
+					n++;
+				}
+			}
+			else
+			{
+				uint32_t usage = field->usage_min + (uint32_t)(value - field->logical_min);
+				if(HID_USAGE_ID(usage) != 0 && usage <= field->usage_max)
+				{
+					out[n].usage = usage;
+					out[n].value = 1;
+					n++;
+				}
+			}
+		}
+	}
+	return n;
+}
+
+bool hid_is_relative(const HID_LAYOUT *layout, uint32_t usage)
+{
+	for(uint8_t f = 0; f < layout->field_count; f++)
+	{
+		const HID_FIELD *field = &layout->fields[f];
+		if((field->flags & 0x06) == 0x06 && usage >= field->usage_min && usage <= field->usage_max)
+		{
+			return true;
+		}
+	}
+	return false;
+}
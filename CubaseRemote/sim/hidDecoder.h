@@ -0,0 +1,58 @@
+/*
+ * hidDecoder.h
+ *
+ * Minimal HID report descriptor parser. It turns input reports into the
+ * set of usages they hold, so the simulator follows any change to
+ * usbHidReportDescriptor without knowing the report structs in main.c.
+ *
+ * Created: 17-Oct-26 10:02:18 AM
+ */ 
+
+
+#ifndef HIDDECODER_H_
+#define HIDDECODER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define HID_MAX_FIELDS		16
+#define HID_MAX_USAGES		32
+
+#define HID_USAGE(page, id)	(((uint32_t)(page) << 16) | (uint16_t)(id))
+#define HID_USAGE_PAGE(u)	((uint16_t)((u) >> 16))
+#define HID_USAGE_ID(u)		((uint16_t)(u))
+
+typedef struct
+{
+	uint8_t  report_id;
+	uint8_t  flags;			// main item data: bit 1 variable, bit 2 relative
+	uint16_t bit_offset;	// from the first byte after the report ID
+	uint8_t  size;
+	uint8_t  count;
+	int32_t  logical_min;
+	uint32_t usage_min;
+	uint32_t usage_max;
+} HID_FIELD;
+
+typedef struct
+{
+	HID_FIELD fields[HID_MAX_FIELDS];
+	uint8_t   field_count;
+	bool      uses_report_ids;
+} HID_LAYOUT;
+
+typedef struct
+{
+	uint32_t usage;
+	int32_t  value;			// 1 for buttons and array entries, the delta for relative fields
+} HID_USAGE_VALUE;
+
+bool hid_parse_descriptor(const uint8_t *descriptor, uint16_t length, HID_LAYOUT *layout);
+
+// Returns the number of usages written to 'out'; relative fields report only non-zero deltas.
+uint8_t hid_decode_input(const HID_LAYOUT *layout, const uint8_t *report, uint8_t length,
+	uint8_t *report_id, HID_USAGE_VALUE *out, uint8_t max);
+
+bool hid_is_relative(const HID_LAYOUT *layout, uint32_t usage);
+
+#endif /* HIDDECODER_H_ */
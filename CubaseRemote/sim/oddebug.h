@@ -0,0 +1,18 @@
+/*
+ * oddebug.h
+ *
+ * Host stand-in for the V-USB debug helpers. Debug output is compiled out,
+ * exactly as with DEBUG_LEVEL=0 on the device.
+ *
+ * Created: 17-Oct-26 9:20:12 AM
+ */ 
+
+
+#ifndef __oddebug_h_included__
+#define __oddebug_h_included__
+
+#define odDebugInit()
+#define DBG1(prefix, data, len)
+#define DBG2(prefix, data, len)
+
+#endif /* __oddebug_h_included__ */
@@ -0,0 +1,1310 @@
+/*
+ * simMain.c
+ *
+ * Command line front end for the host simulation. It plays a pin waveform
+ * script into the firmware, decodes every report the host picks up and
+ * matches it back to the input that caused it.
+ *
+ * Script format, one event per line, '#' starts a comment:
+ *
+ *   <time_ms> press   <button> [bounce_ms] [layer]
+ *   <time_ms> release <button> [bounce_ms] [layer]
+ *   <time_ms> tap     <button> <hold_ms> [layer | none | <page>:<id>]
+ *   <time_ms> spin    cw|ccw <detents> <ms_per_detent>
+ *   <time_ms> remap   <layer> <button> <modifiers> <key>
+ *   <time_ms> remap   <layer> <button> consumer <usage>
+ *   <time_ms> remap   <layer> cw|ccw wheel|pan <units>
+ *   <time_ms> gesture <layer> <button> long|taphold|double <key>
+ *   <time_ms> hires   on|off
+ *   <time_ms> end
+ *
+ * <button> is 1..6 for BTN1..BTN6 or 'enc' for the encoder switch.
+ * 'layer' marks a button that switches keymap layers: it sends no usage,
+ * so its edges are not expected to show up in a report. A tap can name
+ * the usage its press must turn on, in hex as the reports are printed
+ * (7:16 for S), or 'none' if another tap reports its gesture, such as the
+ * first of a double tap; a different usage counts as wrong.
+ * 'remap' reads the keymap feature report, points the button's entry at a
+ * plain key (modifiers and HID key code, C number syntax) or a consumer
+ * usage and writes it back, as a configurator on the host would (again
+ * while the device is still saving the last keymap); with
+ * cw or ccw it sets an encoder direction to scroll by <units> per step.
+ * 'gesture' sets the button's mode and points its alt at a plain key, so
+ * a long press, a tap-hold or a double tap sends that key instead.
+ * Remaps on consecutive lines with the same time go out in one write.
+ * 'hires' sets the wheel resolution multipliers, as Linux does at probe.
+ * A wheel report completes every detent still waiting, however many it
+ * carries.
+ *
+ * With -u the run is paced to the wall clock and every report is also
+ * handed to the Linux input stack through /dev/uhid (see uhidBridge.c),
+ * which adds the latency up to the evdev event to the report latency.
+ *
+ * Created: 17-Oct-26 10:40:22 AM
+ */ 
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "usbconfig.h"
+#include "usbdrv.h"
+#include "simulator.h"
+#include "hidDecoder.h"
+#include "uhidBridge.h"
+#include "eventQueue.h"
+#include "reportScheduler.h"
+#include "keymap.h"
+#include "USB/usb_hid_consumer.h"
+#include "eepromWriter.h"
+#include "profiler.h"
+#include "latency.h"
+#include "util/crc16.h"
+
+#define NS_PER_MS		1000000ULL
+#define BOUNCE_STEP_NS	200000ULL		// contact chatter toggles every 0.2 ms
+#define SETTLE_NS		(1000 * NS_PER_MS)
+
+#define HID_REPORT_FEATURE	3		// GET/SET_REPORT wValue high byte
+
+enum PIN_TARGET
+{
+	PIN_BUTTON,
+	PIN_ENCODER,
+	PIN_REMAP,			// not a pin: index is the remap to start
+	PIN_RESOLUTION,		// not a pin: value is the multiplier setting to write
+	PIN_IDLE,			// not a pin: SET_IDLE of 'value' to interface 'index'
+};
+
+typedef struct
+{
+	uint64_t t;
+	uint32_t seq;
+	uint8_t  target;
+	uint8_t  index;
+	uint8_t  value;
+} PIN_EVENT;
+
+enum STIMULUS_KIND
+{
+	STIMULUS_PRESS,
+	STIMULUS_RELEASE,
+	STIMULUS_DETENT,
+};
+
+typedef struct
+{
+	uint64_t t;
+	uint8_t  kind;
+	uint8_t  index;			// button, or 0 = cw / 1 = ccw for detents
+	bool     matched;
+	bool     cancelled;		// detent taken back by a turn the other way
+	uint64_t latency;
+	uint32_t usage;			// usage a press turned on
+	uint32_t expected;		// usage the press must turn on, 0 = any
+} STIMULUS;
+
+typedef struct
+{
+	uint64_t count;
+	uint64_t min, max, total;
+} LATENCY;
+
+// REMAP.button beyond the buttons selects an encoder direction.
+#define REMAP_CW	SIM_BUTTON_COUNT
+#define REMAP_CCW	(SIM_BUTTON_COUNT + 1)
+
+// The firmware turns a keymap down while it still saves the last one, so
+// a write is tried again the way a configurator would.
+#define REMAP_RETRY_NS	(20 * NS_PER_MS)
+#define REMAP_RETRIES	150
+
+typedef struct
+{
+	uint8_t layer;
+	uint8_t button;
+	uint8_t mode;				// KEYBOARD_MAP_MDOE; other than ON_PRESSED 'action' is the alt
+	KEYBOARD_ACTION action;
+} REMAP;
+
+enum REMAP_STAGE
+{
+	REMAP_IDLE,
+	REMAP_READ,
+	REMAP_WRITE,
+	REMAP_RESOLUTION,	// writing the wheel resolution instead
+};
+
+static struct
+{
+	PIN_EVENT *pins;
+	size_t pin_count, pin_capacity, pin_next;
+
+	STIMULUS *stimuli;
+	size_t stimulus_count, stimulus_capacity, stimulus_next_unmatched;
+
+	uint64_t end;
+	bool verbose;
+	bool uhid;
+
+	HID_LAYOUT layout;
+	HID_USAGE_VALUE active[256][HID_MAX_USAGES];
+	uint8_t active_count[256];
+
+	uint64_t activations, extra;
+	uint64_t accelerated;		// encoder steps beyond their detents
+	uint64_t step_trail;		// how long those may follow the last detent's report
+	LATENCY press_latency, release_latency, detent_latency;
+	LATENCY evdev_press_latency, evdev_release_latency, evdev_detent_latency;
+	uint64_t evdev_silent;		// inputs whose report caused no evdev event
+	uint32_t held_usage[SIM_BUTTON_COUNT];	// usage of the last matched press per button
+	uint64_t held_since[SIM_BUTTON_COUNT];	// and the time of that press
+	STEP_THROUGHPUT peak_steps;
+
+	REMAP *remaps;
+	size_t remap_count, remap_capacity, remap_current, remap_end;
+	uint8_t remap_stage;
+	unsigned remap_failed;
+	unsigned wrong;				// presses that turned on another usage than expected
+	unsigned remap_retries;		// of the current remap
+	uint64_t remap_retry;		// when to write it again, SIM_NEVER if not
+} sim;
+
+static void *grow(void *array, size_t *capacity, size_t count, size_t size)
+{
+	if(count < *capacity)
+	{
+		return array;
+	}
+	*capacity = *capacity ? *capacity * 2 : 64;
+	array = realloc(array, *capacity * size);
+	if(array == NULL)
+	{
+		fprintf(stderr, "out of memory\n");
+		exit(2);
+	}
+	return array;
+}
+
+static void add_pin(uint64_t t, uint8_t target, uint8_t index, uint8_t value)
+{
+	sim.pins = grow(sim.pins, &sim.pin_capacity, sim.pin_count, sizeof(PIN_EVENT));
+	sim.pins[sim.pin_count] = (PIN_EVENT){ t, (uint32_t)sim.pin_count, target, index, value };
+	sim.pin_count++;
+	if(t > sim.end)
+	{
+		sim.end = t;
+	}
+}
+
+static void add_stimulus(uint64_t t, uint8_t kind, uint8_t index)
+{
+	sim.stimuli = grow(sim.stimuli, &sim.stimulus_capacity, sim.stimulus_count, sizeof(STIMULUS));
+	sim.stimuli[sim.stimulus_count++] = (STIMULUS){ t, kind, index, false, false, 0, 0, 0 };
+}
+
+static void add_button_edge(uint64_t t, uint8_t button, bool pressed, uint64_t bounce, bool reported)
+{
+	uint8_t level = pressed ? 1 : 0;
+
+	for(uint64_t dt = 0; dt < bounce; dt += BOUNCE_STEP_NS)
+	{
+		add_pin(t + dt, PIN_BUTTON, button, level);
+		level ^= 1;
+	}
+	add_pin(t + bounce, PIN_BUTTON, button, pressed ? 1 : 0);
+	if(reported)
+	{
+		add_stimulus(t, pressed ? STIMULUS_PRESS : STIMULUS_RELEASE, button);
+	}
+}
+
+static void add_detents(uint64_t t, bool cw, unsigned count, uint64_t period)
+{
+	static const uint8_t cw_sequence[4]  = { 0x01, 0x00, 0x02, 0x03 };
+	static const uint8_t ccw_sequence[4] = { 0x02, 0x00, 0x01, 0x03 };
+	const uint8_t *sequence = cw ? cw_sequence : ccw_sequence;
+
+	for(unsigned d = 0; d < count; d++)
+	{
+		for(uint8_t q = 0; q < 4; q++)
+		{
+			add_pin(t + d * period + q * period / 4, PIN_ENCODER, 0, sequence[q]);
+		}
+		add_stimulus(t + d * period + 3 * period / 4, STIMULUS_DETENT, cw ? 0 : 1);
+	}
+}
+
+/* 'mode' other than ON_PRESSED makes 'key' the button's alt instead. */
+static bool add_remap(uint64_t t, const char *layer, int button, uint8_t mode, const char *modifiers, const char *key)
+{
+	if(button < 0 || atoi(layer) < 0 || atoi(layer) >= KEYBOARD_LAYER_COUNT || sim.remap_count > UINT8_MAX)
+	{
+		return false;
+	}
+	sim.remaps = grow(sim.remaps, &sim.remap_capacity, sim.remap_count, sizeof(REMAP));
+	if(mode != ON_PRESSED && button >= SIM_BUTTON_COUNT)
+	{
+		return false;
+	}
+	if(button >= REMAP_CW)
+	{
+		if(strcmp(modifiers, "wheel") != 0 && strcmp(modifiers, "pan") != 0)
+		{
+			return false;
+		}
+		sim.remaps[sim.remap_count] = (REMAP){ (uint8_t)atoi(layer), (uint8_t)button, ON_PRESSED,
+			{ ACTION_WHEEL, (uint8_t)(int8_t)strtol(key, NULL, 0), modifiers[0] == 'w' ? MOUSE_AXIS_WHEEL : MOUSE_AXIS_PAN } };
+	}
+	else if(strcmp(modifiers, "consumer") == 0)
+	{
+		long usage = strtol(key, NULL, 0);
+		if(usage <= 0 || usage > HID_CONSUMER_USAGE_MAX)
+		{
+			return false;
+		}
+		sim.remaps[sim.remap_count] = (REMAP){ (uint8_t)atoi(layer), (uint8_t)button, ON_PRESSED,
+			KEYBOARD_CONSUMER_ACTION(usage) };
+	}
+	else
+	{
+		sim.remaps[sim.remap_count] = (REMAP){ (uint8_t)atoi(layer), (uint8_t)button, mode,
+			{ ACTION_KEY, (uint8_t)strtol(modifiers, NULL, 0), (uint8_t)strtol(key, NULL, 0) } };
+	}
+	add_pin(t, PIN_REMAP, (uint8_t)sim.remap_count, 0);
+	sim.remap_count++;
+	return true;
+}
+
+static int parse_button(const char *s)
+{
+	if(strcmp(s, "enc") == 0)
+	{
+		return 6;
+	}
+	int b = atoi(s);
+	return (b >= 1 && b <= 6) ? b - 1 : -1;
+}
+
+static bool load_script(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	char line[256];
+	unsigned lineno = 0;
+	uint64_t explicit_end = 0;
+
+	if(f == NULL)
+	{
+		perror(path);
+		return false;
+	}
+	while(fgets(line, sizeof(line), f))
+	{
+		char cmd[16], a[16] = "", b[16] = "", c[16] = "", d[16] = "";
+		double ms;
+		char *hash = strchr(line, '#');
+
+		lineno++;
+		if(hash)
+		{
+			*hash = 0;
+		}
+		int n = sscanf(line, "%lf %15s %15s %15s %15s %15s", &ms, cmd, a, b, c, d);
+		if(n <= 0)
+		{
+			continue;
+		}
+		uint64_t t = (uint64_t)(ms * NS_PER_MS);
+		int button = parse_button(a);
+		bool ok = true;
+
+		if(n >= 3 && (strcmp(cmd, "press") == 0 || strcmp(cmd, "release") == 0) && button >= 0)
+		{
+			uint64_t bounce = n >= 4 ? (uint64_t)(atof(b) * NS_PER_MS) : 0;
+			bool layer = strcmp(b, "layer") == 0 || strcmp(c, "layer") == 0;
+			add_button_edge(t, (uint8_t)button, cmd[0] == 'p', bounce, !layer);
+		}
+		else if(n >= 4 && strcmp(cmd, "tap") == 0 && button >= 0)
+		{
+			bool reported = strcmp(c, "layer") != 0 && strcmp(c, "none") != 0;
+			unsigned page, id;
+			add_button_edge(t, (uint8_t)button, true, 0, reported);
+			if(reported && sscanf(c, "%x:%x", &page, &id) == 2)
+			{
+				sim.stimuli[sim.stimulus_count - 1].expected = HID_USAGE(page, id);
+			}
+			add_button_edge(t + (uint64_t)(atof(b) * NS_PER_MS), (uint8_t)button, false, 0, reported);
+		}
+		else if(n >= 5 && strcmp(cmd, "spin") == 0 && (strcmp(a, "cw") == 0 || strcmp(a, "ccw") == 0))
+		{
+			add_detents(t, strcmp(a, "cw") == 0, (unsigned)atoi(b), (uint64_t)(atof(c) * NS_PER_MS));
+		}
+		else if(n >= 6 && strcmp(cmd, "gesture") == 0)
+		{
+			uint8_t mode = strcmp(c, "long") == 0 ? LONG_PRESS : strcmp(c, "taphold") == 0 ? TAP_HOLD
+				: strcmp(c, "double") == 0 ? DOUBLE_TAP : ON_PRESSED;
+			ok = mode != ON_PRESSED && add_remap(t, a, parse_button(b), mode, "0", d);
+		}
+		else if(n >= 6 && strcmp(cmd, "remap") == 0)
+		{
+			int target = strcmp(b, "cw") == 0 ? REMAP_CW : strcmp(b, "ccw") == 0 ? REMAP_CCW : parse_button(b);
+			ok = add_remap(t, a, target, ON_PRESSED, c, d);
+		}
+		else if(n >= 3 && strcmp(cmd, "hires") == 0 && (strcmp(a, "on") == 0 || strcmp(a, "off") == 0))
+		{
+			add_pin(t, PIN_RESOLUTION, 0, strcmp(a, "on") == 0);
+		}
+		else if(n >= 2 && strcmp(cmd, "end") == 0)
+		{
+			explicit_end = t;
+		}
+		else
+		{
+			ok = false;
+		}
+		if(!ok)
+		{
+			fprintf(stderr, "%s:%u: cannot parse '%s'\n", path, lineno, cmd);
+			fclose(f);
+			return false;
+		}
+	}
+	fclose(f);
+
+	sim.end = explicit_end ? explicit_end : sim.end + SETTLE_NS;
+	return true;
+}
+
+static int compare_pins(const void *a, const void *b)
+{
+	const PIN_EVENT *pa = a, *pb = b;
+	if(pa->t != pb->t)
+	{
+		return pa->t < pb->t ? -1 : 1;
+	}
+	return pa->seq < pb->seq ? -1 : 1;
+}
+
+static int compare_stimuli(const void *a, const void *b)
+{
+	const STIMULUS *sa = a, *sb = b;
+	if(sa->t != sb->t)
+	{
+		return sa->t < sb->t ? -1 : 1;
+	}
+	return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static uint64_t next_stimulus(void *ctx)
+{
+	uint64_t next = sim.pin_next < sim.pin_count ? sim.pins[sim.pin_next].t : SIM_NEVER;
+
+	(void)ctx;
+	return sim.remap_retry < next ? sim.remap_retry : next;
+}
+
+static void start_remap(void)
+{
+	sim.remap_stage = REMAP_READ;
+	sim_control_read(USBRQ_TYPE_CLASS | USBRQ_RCPT_INTERFACE | USBRQ_DIR_DEVICE_TO_HOST,
+		USBRQ_HID_GET_REPORT, HID_REPORT_FEATURE << 8 | REPORT_ID_KEYMAP, 0, 254);
+}
+
+static void apply_stimulus(void *ctx, uint64_t now)
+{
+	(void)ctx;
+	if(sim.remap_retry <= now)
+	{
+		sim.remap_retry = SIM_NEVER;
+		start_remap();
+	}
+	while(sim.pin_next < sim.pin_count && sim.pins[sim.pin_next].t <= now)
+	{
+		const PIN_EVENT *e = &sim.pins[sim.pin_next++];
+		if(sim.uhid)
+		{
+			uhid_wait(e->t);
+		}
+		if(e->target == PIN_BUTTON)
+		{
+			sim_set_button(e->index, e->value != 0);
+		}
+		else if(e->target == PIN_REMAP)
+		{
+			// Following remaps at the same time join the same write.
+			sim.remap_current = e->index;
+			sim.remap_end = e->index + 1;
+			while(sim.pin_next < sim.pin_count && sim.pins[sim.pin_next].t == e->t
+				&& sim.pins[sim.pin_next].target == PIN_REMAP && sim.pins[sim.pin_next].index == sim.remap_end)
+			{
+				sim.remap_end++;
+				sim.pin_next++;
+			}
+			sim.remap_retries = 0;
+			start_remap();
+		}
+		else if(e->target == PIN_IDLE)
+		{
+			/* wValue: duration in 4 ms units (highbyte), report ID 0 = all */
+			sim_control_request(USBRQ_TYPE_CLASS | USBRQ_RCPT_INTERFACE | USBRQ_DIR_HOST_TO_DEVICE,
+				USBRQ_HID_SET_IDLE, (uint16_t)(e->value << 8), e->index);
+		}
+		else if(e->target == PIN_RESOLUTION)
+		{
+			// Both axes; the feature report belongs to the mouse on interface 1.
+			const uint8_t feature[MOUSE_FEATURE_LENGTH] = { REPORT_ID_MOUSE, e->value ? 0x05 : 0x00 };
+			sim.remap_stage = REMAP_RESOLUTION;
+			sim_control_write(USBRQ_TYPE_CLASS | USBRQ_RCPT_INTERFACE | USBRQ_DIR_HOST_TO_DEVICE,
+				USBRQ_HID_SET_REPORT, HID_REPORT_FEATURE << 8 | REPORT_ID_MOUSE, 1, feature, sizeof(feature));
+		}
+		else
+		{
+			sim_set_encoder(e->value);
+		}
+	}
+}
+
+static void record_latency(LATENCY *l, uint64_t latency)
+{
+	if(l->count == 0 || latency < l->min)
+	{
+		l->min = latency;
+	}
+	if(latency > l->max)
+	{
+		l->max = latency;
+	}
+	l->total += latency;
+	l->count++;
+}
+
+static bool is_modifier(uint32_t usage)
+{
+	return HID_USAGE_PAGE(usage) == 0x07 && HID_USAGE_ID(usage) >= 0xE0 && HID_USAGE_ID(usage) <= 0xE7;
+}
+
+static bool action_produces(const KEYBOARD_ACTION *action, uint32_t usage)
+{
+	const uint8_t *macros = keymap_get_macros();
+	uint16_t offset = 0;
+	uint8_t id;
+
+	switch(action->type)
+	{
+		case ACTION_KEY:
+			if(action->hidCode != 0 && usage == HID_USAGE(0x07, action->hidCode))
+			{
+				return true;
+			}
+			return is_modifier(usage) && (action->modifiers & (1 << (HID_USAGE_ID(usage) - 0xE0)));
+
+		case ACTION_CONSUMER:
+			return usage == HID_USAGE(0x0C, KEYBOARD_ACTION_USAGE(action));
+
+		case ACTION_WHEEL:
+			return usage == (action->hidCode == MOUSE_AXIS_WHEEL ? HID_USAGE(0x01, 0x38) : HID_USAGE(0x0C, 0x238));
+
+		case ACTION_MACRO:
+			// The first step goes out with the press, see macro_start()
+			// for the layout; the others are macro steps.
+			for(id = action->hidCode; id != 0 && offset < KEYMAP_MACRO_BYTES; offset += MACRO_STEP_SIZE)
+			{
+				if(macros[offset] == 0 && macros[offset + 1] == 0)
+				{
+					id--;
+				}
+			}
+			if(offset < KEYMAP_MACRO_BYTES && (macros[offset] || macros[offset + 1]))
+			{
+				KEYBOARD_ACTION step = { ACTION_KEY, macros[offset], macros[offset + 1] };
+				return action_produces(&step, usage);
+			}
+			return false;
+
+		default:
+			return false;
+	}
+}
+
+/* True if 'usage' is a key of any macro step after the first. */
+static bool is_macro_step(uint32_t usage)
+{
+	const uint8_t *macros = keymap_get_macros();
+	bool first = true;
+
+	for(uint16_t offset = 0; offset < KEYMAP_MACRO_BYTES; offset += MACRO_STEP_SIZE)
+	{
+		KEYBOARD_ACTION step = { ACTION_KEY, macros[offset], macros[offset + 1] };
+		if(step.modifiers == 0 && step.hidCode == 0)
+		{
+			first = true;
+			continue;
+		}
+		if(!first && action_produces(&step, usage))
+		{
+			return true;
+		}
+		first = false;
+	}
+	return false;
+}
+
+/* True if the input can put 'usage' in a report in any layer of the
+ * current keymap, through its action or its gesture alt. */
+static bool stimulus_produces(const STIMULUS *s, uint32_t usage)
+{
+	for(uint8_t layer = 0; layer < KEYBOARD_LAYER_COUNT; layer++)
+	{
+		if(s->kind == STIMULUS_DETENT)
+		{
+			const KEYBOARD_LAYER *entry = keymap_get_layer(layer);
+			if(action_produces(s->index ? &entry->encoderCcw : &entry->encoderCw, usage))
+			{
+				return true;
+			}
+		}
+		else
+		{
+			const struct KEYBOARD_KEY *key = keymap_get_key(layer, s->index);
+			if(action_produces(&key->action, usage) || action_produces(&key->alt, usage))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/* Finds the oldest press or detent that has not produced a report yet and
+ * can produce 'usage'. */
+static STIMULUS *oldest_unmatched(uint64_t now, uint32_t usage)
+{
+	for(size_t i = sim.stimulus_next_unmatched; i < sim.stimulus_count; i++)
+	{
+		STIMULUS *s = &sim.stimuli[i];
+		if(s->t > now)
+		{
+			break;
+		}
+		if(!s->matched && s->kind != STIMULUS_RELEASE && stimulus_produces(s, usage))
+		{
+			return s;
+		}
+	}
+	return NULL;
+}
+
+static void claim_stimulus(STIMULUS *s, uint64_t now, uint32_t usage)
+{
+	s->matched = true;
+	s->latency = now - s->t;
+	s->usage = usage;
+	if(s->kind == STIMULUS_PRESS)
+	{
+		sim.held_usage[s->index] = usage;
+		sim.held_since[s->index] = s->t;
+	}
+	record_latency(s->kind == STIMULUS_DETENT ? &sim.detent_latency : &sim.press_latency, s->latency);
+	if(s->expected != 0 && usage != s->expected)
+	{
+		sim.wrong++;
+	}
+	if(sim.verbose)
+	{
+		printf("%10.3f ms   usage %04x:%04x  <- %s %u at %.3f ms (%.3f ms)%s\n",
+			now / 1e6, HID_USAGE_PAGE(usage), HID_USAGE_ID(usage),
+			s->kind == STIMULUS_DETENT ? (s->index ? "ccw" : "cw") : "press",
+			s->kind == STIMULUS_DETENT ? 1 : s->index + 1, s->t / 1e6, s->latency / 1e6,
+			s->expected != 0 && usage != s->expected ? "  wrong" : "");
+	}
+	while(sim.stimulus_next_unmatched < sim.stimulus_count
+		&& (sim.stimuli[sim.stimulus_next_unmatched].matched
+			|| sim.stimuli[sim.stimulus_next_unmatched].kind == STIMULUS_RELEASE))
+	{
+		sim.stimulus_next_unmatched++;
+	}
+}
+
+static void unexplained(uint64_t now, uint32_t usage)
+{
+	sim.extra++;
+	if(sim.verbose)
+	{
+		printf("%10.3f ms   usage %04x:%04x  <- no input\n", now / 1e6, HID_USAGE_PAGE(usage), HID_USAGE_ID(usage));
+	}
+}
+
+/* Acceleration turns a detent into several steps of a key or consumer
+ * action, which the scheduler holds to ENCODER_ONESHOT_BACKLOG_MAX. A step
+ * no detent is waiting for is one of those if it follows the report of a
+ * detent mapped to it within the time that backlog takes to go out. */
+static bool is_accelerated_step(uint64_t now, uint32_t usage)
+{
+	for(size_t i = sim.stimulus_count; i-- != 0; )
+	{
+		const STIMULUS *s = &sim.stimuli[i];
+		if(s->matched && s->kind == STIMULUS_DETENT && s->usage == usage)
+		{
+			return now - (s->t + s->latency) <= sim.step_trail;
+		}
+	}
+	return false;
+}
+
+/* A usage that appears in a report is matched to the oldest press or
+ * detent that has not produced a report yet and is mapped to that usage.
+ * Reports on the keyboard and consumer endpoints overtake each other, and
+ * a backlog of encoder steps can outlast its detents; neither may claim an
+ * input that maps to something else, which would then count as on time
+ * although its own report is late or never comes. Accelerated steps do not
+ * follow detents one to one, so a step completes every detent mapped to it
+ * that is waiting. */
+static STIMULUS *match_activation(uint64_t now, uint32_t usage)
+{
+	STIMULUS *s = oldest_unmatched(now, usage);
+
+	if(s == NULL && is_macro_step(usage))
+	{
+		// Played by the macro whose press the first step was matched to.
+		if(sim.verbose)
+		{
+			printf("%10.3f ms   usage %04x:%04x  <- macro step\n", now / 1e6, HID_USAGE_PAGE(usage), HID_USAGE_ID(usage));
+		}
+		return NULL;
+	}
+	if(s == NULL && is_accelerated_step(now, usage))
+	{
+		sim.accelerated++;
+		if(sim.verbose)
+		{
+			printf("%10.3f ms   usage %04x:%04x  <- accelerated step\n", now / 1e6, HID_USAGE_PAGE(usage), HID_USAGE_ID(usage));
+		}
+		return NULL;
+	}
+	sim.activations++;
+	if(s == NULL)
+	{
+		unexplained(now, usage);
+		return NULL;
+	}
+	claim_stimulus(s, now, usage);
+	for(size_t i = s - sim.stimuli + 1; s->kind == STIMULUS_DETENT && i < sim.stimulus_count
+		&& sim.stimuli[i].t <= now; i++)
+	{
+		STIMULUS *later = &sim.stimuli[i];
+		if(!later->matched && later->kind == STIMULUS_DETENT && stimulus_produces(later, usage))
+		{
+			claim_stimulus(later, now, usage);
+		}
+	}
+	return s;
+}
+
+/* Wheel motion adds up, so a relative usage completes every detent mapped
+ * to it that has not produced a report yet. Returns how many went into 'matched'. */
+static uint8_t match_motion(uint64_t now, uint32_t usage, STIMULUS **matched, uint8_t max)
+{
+	uint8_t n = 0;
+	bool any = false;
+
+	for(size_t i = sim.stimulus_next_unmatched; i < sim.stimulus_count && sim.stimuli[i].t <= now; i++)
+	{
+		STIMULUS *s = &sim.stimuli[i];
+		if(!s->matched && s->kind == STIMULUS_DETENT && stimulus_produces(s, usage))
+		{
+			sim.activations++;
+			claim_stimulus(s, now, usage);
+			any = true;
+			if(n < max)
+			{
+				matched[n++] = s;
+			}
+		}
+	}
+	if(!any)
+	{
+		sim.activations++;
+		unexplained(now, usage);
+	}
+	return n;
+}
+
+/* A usage that leaves a report is matched to the oldest release of the
+ * button whose press turned it on, after that press. Releases that come
+ * after the usage has already gone, such as taps and macros, are not
+ * measured. */
+static STIMULUS *match_deactivation(uint64_t now, uint32_t usage)
+{
+	for(size_t i = 0; i < sim.stimulus_count; i++)
+	{
+		STIMULUS *s = &sim.stimuli[i];
+		if(s->t > now)
+		{
+			break;
+		}
+		if(s->matched || s->kind != STIMULUS_RELEASE || sim.held_usage[s->index] != usage
+			|| s->t < sim.held_since[s->index])
+		{
+			continue;
+		}
+		s->matched = true;
+		s->latency = now - s->t;
+		s->usage = usage;
+		sim.held_usage[s->index] = 0;
+		record_latency(&sim.release_latency, s->latency);
+		if(sim.verbose)
+		{
+			printf("%10.3f ms   usage %04x:%04x  -> release %u at %.3f ms (%.3f ms)\n",
+				now / 1e6, HID_USAGE_PAGE(usage), HID_USAGE_ID(usage),
+				s->index + 1, s->t / 1e6, s->latency / 1e6);
+		}
+		return s;
+	}
+	return NULL;
+}
+
+static bool is_active(uint32_t usage)
+{
+	for(unsigned id = 0; id < 256; id++)
+	{
+		for(uint8_t j = 0; j < sim.active_count[id]; j++)
+		{
+			if(sim.active[id][j].usage == usage)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/* Sends the report on to evdev at its simulated time and measures each
+ * input it completed from the input's own time to the evdev event. */
+static void forward_report(uint64_t now, const uint8_t *data, uint8_t len, STIMULUS *const *matched, uint8_t count)
+{
+	uint64_t event;
+
+	uhid_wait(now);
+	event = uhid_send(data, len);
+	for(uint8_t i = 0; i < count; i++)
+	{
+		const STIMULUS *s = matched[i];
+		LATENCY *l = s->kind == STIMULUS_DETENT ? &sim.evdev_detent_latency
+			: s->kind == STIMULUS_PRESS ? &sim.evdev_press_latency : &sim.evdev_release_latency;
+
+		if(event == 0)
+		{
+			sim.evdev_silent++;
+			continue;
+		}
+		record_latency(l, event - uhid_wall_time(s->t));
+	}
+}
+
+static void on_report(void *ctx, uint64_t now, const uint8_t *data, uint8_t len)
+{
+	HID_USAGE_VALUE usages[HID_MAX_USAGES];
+	uint8_t id;
+	uint8_t n = hid_decode_input(&sim.layout, data, len, &id, usages, HID_MAX_USAGES);
+
+	(void)ctx;
+	uint32_t fresh[HID_MAX_USAGES];
+	uint8_t fresh_count = 0;
+	bool has_key = false;
+	STIMULUS *matched[2 * HID_MAX_USAGES];
+	uint8_t matched_count = 0;
+
+	for(uint8_t i = 0; i < n; i++)
+	{
+		bool was_active = false;
+		if(!hid_is_relative(&sim.layout, usages[i].usage))
+		{
+			for(uint8_t j = 0; j < sim.active_count[id]; j++)
+			{
+				if(sim.active[id][j].usage == usages[i].usage)
+				{
+					was_active = true;
+				}
+			}
+		}
+		if(!was_active)
+		{
+			fresh[fresh_count++] = usages[i].usage;
+			has_key |= !is_modifier(usages[i].usage);
+		}
+	}
+	/* Modifiers that come with a key belong to that key's shortcut. */
+	for(uint8_t i = 0; i < fresh_count; i++)
+	{
+		if(hid_is_relative(&sim.layout, fresh[i]))
+		{
+			matched_count += match_motion(now, fresh[i], &matched[matched_count],
+				(uint8_t)(sizeof(matched) / sizeof(matched[0]) - matched_count));
+		}
+		else if(!has_key || !is_modifier(fresh[i]))
+		{
+			matched[matched_count] = match_activation(now, fresh[i]);
+			matched_count += matched[matched_count] != NULL;
+		}
+	}
+	for(uint8_t j = 0; j < sim.active_count[id]; j++)
+	{
+		bool still_active = false;
+		for(uint8_t i = 0; i < n; i++)
+		{
+			if(usages[i].usage == sim.active[id][j].usage)
+			{
+				still_active = true;
+			}
+		}
+		if(!still_active && !hid_is_relative(&sim.layout, sim.active[id][j].usage))
+		{
+			matched[matched_count] = match_deactivation(now, sim.active[id][j].usage);
+			matched_count += matched[matched_count] != NULL;
+		}
+	}
+	memcpy(sim.active[id], usages, n * sizeof(usages[0]));
+	sim.active_count[id] = n;
+
+	if(sim.uhid)
+	{
+		forward_report(now, data, len, matched, matched_count);
+	}
+
+	STEP_THROUGHPUT steps;
+	reportScheduler_get_throughput(&steps);
+	if(steps.requested > sim.peak_steps.requested)
+	{
+		sim.peak_steps.requested = steps.requested;
+	}
+	if(steps.delivered > sim.peak_steps.delivered)
+	{
+		sim.peak_steps.delivered = steps.delivered;
+	}
+}
+
+static void remap_failed(uint64_t now, const char *why)
+{
+	sim.remap_failed++;
+	sim.remap_stage = REMAP_IDLE;
+	if(sim.verbose)
+	{
+		printf("%10.3f ms   keymap %s\n", now / 1e6, why);
+	}
+}
+
+static void apply_remap(const REMAP *r, KEYMAP_IMAGE *keymap)
+{
+	KEYBOARD_LAYER *layer = &keymap->layers[r->layer];
+
+	if(r->button == REMAP_CW || r->button == REMAP_CCW)
+	{
+		*(r->button == REMAP_CW ? &layer->encoderCw : &layer->encoderCcw) = r->action;
+	}
+	else if(r->mode != ON_PRESSED)
+	{
+		layer->keys[r->button].mode = r->mode;
+		layer->keys[r->button].alt = r->action;
+	}
+	else
+	{
+		layer->keys[r->button].mode = ON_PRESSED;
+		layer->keys[r->button].action = r->action;
+	}
+}
+
+static void print_remap(uint64_t now, const REMAP *r)
+{
+	if(r->button >= REMAP_CW)
+	{
+		printf("%10.3f ms   keymap layer %u %s -> %s %d\n", now / 1e6, r->layer,
+			r->button == REMAP_CW ? "cw" : "ccw", r->action.hidCode == MOUSE_AXIS_WHEEL ? "wheel" : "pan",
+			(int8_t)r->action.modifiers);
+	}
+	else
+	{
+		printf("%10.3f ms   keymap layer %u button %u -> %s%02x:%02x\n", now / 1e6, r->layer, r->button + 1,
+			r->mode == LONG_PRESS ? "long press " : r->mode == TAP_HOLD ? "tap-hold " : r->mode == DOUBLE_TAP ? "double tap " : "",
+			r->action.modifiers, r->action.hidCode);
+	}
+}
+
+/* Patches the keymap read back from the device and writes it again. */
+static void on_control(void *ctx, uint64_t now, bool ok, const uint8_t *data, uint16_t len)
+{
+	uint8_t image[KEYMAP_REPORT_LENGTH];
+	KEYMAP_IMAGE *keymap = (KEYMAP_IMAGE *)&image[1];
+	uint16_t crc = 0xFFFF;
+
+	(void)ctx;
+	if(sim.remap_stage == REMAP_RESOLUTION)
+	{
+		sim.remap_stage = REMAP_IDLE;
+		if(!ok)
+		{
+			remap_failed(now, "wheel resolution rejected");
+		}
+		else if(sim.verbose)
+		{
+			printf("%10.3f ms   wheel resolution set\n", now / 1e6);
+		}
+	}
+	else if(sim.remap_stage == REMAP_READ)
+	{
+		if(!ok || len != sizeof(image) || data[0] != REPORT_ID_KEYMAP)
+		{
+			remap_failed(now, "read failed");
+			return;
+		}
+		memcpy(image, data, len);
+		for(size_t i = sim.remap_current; i < sim.remap_end; i++)
+		{
+			apply_remap(&sim.remaps[i], keymap);
+		}
+		for(uint16_t i = 1 + offsetof(KEYMAP_IMAGE, layers); i < len; i++)
+		{
+			crc = _crc16_update(crc, image[i]);
+		}
+		keymap->crc = crc;
+		sim.remap_stage = REMAP_WRITE;
+		sim_control_write(USBRQ_TYPE_CLASS | USBRQ_RCPT_INTERFACE | USBRQ_DIR_HOST_TO_DEVICE,
+			USBRQ_HID_SET_REPORT, HID_REPORT_FEATURE << 8 | REPORT_ID_KEYMAP, 0, image, len);
+	}
+	else if(sim.remap_stage == REMAP_WRITE)
+	{
+		if(!ok && sim.remap_retries < REMAP_RETRIES)
+		{
+			sim.remap_retries++;
+			sim.remap_stage = REMAP_IDLE;
+			sim.remap_retry = now + REMAP_RETRY_NS;
+			return;
+		}
+		if(!ok)
+		{
+			remap_failed(now, "write rejected");
+			return;
+		}
+		sim.remap_stage = REMAP_IDLE;
+		for(size_t i = sim.remap_current; sim.verbose && i < sim.remap_end; i++)
+		{
+			print_remap(now, &sim.remaps[i]);
+		}
+	}
+}
+
+/* Turning back takes back encoder steps that have not been reported yet,
+ * so a detent that never got a report is not dropped if a later detent
+ * the other way did not get one either. Pairs them up and returns how many
+ * detents that cancelled. */
+static size_t cancel_reversals(void)
+{
+	size_t *open = malloc(sim.stimulus_count * sizeof(size_t));
+	size_t open_count = 0, cancelled = 0;
+
+	if(open == NULL)
+	{
+		fprintf(stderr, "out of memory\n");
+		exit(2);
+	}
+	for(size_t i = 0; i < sim.stimulus_count; i++)
+	{
+		STIMULUS *s = &sim.stimuli[i];
+		if(s->matched || s->kind != STIMULUS_DETENT)
+		{
+			continue;
+		}
+		// Open detents all go one way, a reversal would have paired them.
+		if(open_count != 0 && sim.stimuli[open[open_count - 1]].index != s->index)
+		{
+			sim.stimuli[open[--open_count]].cancelled = true;
+			s->cancelled = true;
+			cancelled += 2;
+		}
+		else
+		{
+			open[open_count++] = i;
+		}
+	}
+	free(open);
+	return cancelled;
+}
+
+static void print_latency(const char *name, const LATENCY *l)
+{
+	if(l->count == 0)
+	{
+		return;
+	}
+	printf("%-8s latency  min %7.3f  avg %7.3f  max %7.3f ms  (%llu)\n", name,
+		l->min / 1e6, (double)l->total / l->count / 1e6, l->max / 1e6, (unsigned long long)l->count);
+}
+
+/* Decodes the REPORT_ID_LATENCY feature report as a host would. */
+static void print_histograms(void)
+{
+	static const char *const names[LATENCY_SOURCE_COUNT] = { "button", "encoder" };
+	uint8_t report[LATENCY_REPORT_LENGTH];
+	uint8_t len;
+
+	latency_report_begin();
+	len = latency_report_read(report, sizeof(report));
+	if(len != LATENCY_REPORT_LENGTH || report[0] != REPORT_ID_LATENCY)
+	{
+		printf("latency report malformed\n");
+		return;
+	}
+	for(uint8_t i = 0; i < LATENCY_SOURCE_COUNT; i++)
+	{
+		struct LATENCY_HISTOGRAM h;
+		double unit = report[1] * 10 / 1000.0;
+		memcpy(&h, &report[2 + i * sizeof(h)], sizeof(h));
+		if(h.count == 0)
+		{
+			continue;
+		}
+		printf("device %-7s avg %.3f max %.3f ms, histogram (ms):", names[i],
+			(double)h.total / h.count * unit, h.max * unit);
+		for(uint8_t b = 0; b < LATENCY_BUCKETS; b++)
+		{
+			if(h.buckets[b] == 0)
+			{
+				continue;
+			}
+			if(b == LATENCY_BUCKETS - 1)
+			{
+				printf(" >=%g:%u", (1u << (b - 1)) * unit, h.buckets[b]);
+			}
+			else
+			{
+				printf(" <%g:%u", (1u << b) * unit, h.buckets[b]);
+			}
+		}
+		printf("\n");
+	}
+}
+
+#ifdef PROFILER
+/* Decodes the REPORT_ID_PROFILE feature report as a host would. */
+static void print_profile(void)
+{
+	static const char *const names[PROFILE_STAGE_COUNT] = {
+		[PROFILE_LOOP] = "loop", [PROFILE_USB_POLL] = "usbPoll",
+		[PROFILE_ENCODER_EVENTS] = "encoder events", [PROFILE_BUTTON_EVENTS] = "button events",
+		[PROFILE_REPORTS] = "reports", [PROFILE_EEPROM] = "eeprom",
+		[PROFILE_TIMER2_ISR] = "timer2 isr", [PROFILE_ENCODER_SAMPLE] = "encoder sample",
+		[PROFILE_BUTTON_SCAN] = "button scan",
+	};
+	uint8_t report[PROFILE_REPORT_LENGTH];
+	uint8_t len;
+
+	profiler_report_begin();
+	len = profiler_report_read(report, sizeof(report));
+
+	if(len != PROFILE_REPORT_LENGTH || report[0] != REPORT_ID_PROFILE)
+	{
+		printf("profile report malformed\n");
+		return;
+	}
+	printf("profile (cycles)      min      avg      max    count\n");
+	for(uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++)
+	{
+		struct PROFILE_STATS s;
+		memcpy(&s, &report[1 + i * sizeof(s)], sizeof(s));
+		if(s.count != 0)
+		{
+			printf("  %-14s %8u %8u %8u %8u\n", names[i], s.min, (unsigned)(s.total / s.count), s.max, s.count);
+		}
+	}
+}
+#endif
+
+static void usage(const char *argv0)
+{
+	fprintf(stderr,
+		"usage: %s [-v] [-u] [-l loop_us] [-p poll_ms] [-i idle_ms] [-e eeprom] script\n"
+		"  -v          print every matched report\n"
+		"  -u          run in real time through /dev/uhid and measure evdev latency\n"
+		"  -l loop_us  simulated time of one main loop pass (default 25)\n"
+		"  -p poll_ms  host interrupt-IN polling interval (default %d)\n"
+		"  -i idle_ms  host sends SET_IDLE to both interfaces at start-up (0 = on change only)\n"
+		"  -e eeprom   EEPROM image file, loaded at reset and saved at the end\n",
+		argv0, USB_CFG_INTR_POLL_INTERVAL);
+}
+
+int main(int argc, char **argv)
+{
+	SIM_CONFIG config;
+	double loop_us = 25.0, poll_ms = USB_CFG_INTR_POLL_INTERVAL, idle_ms = -1.0;
+	const char *eeprom = NULL;
+	uint8_t descriptor[256];
+	uint16_t descriptor_length;
+	int opt;
+
+	while((opt = getopt(argc, argv, "vul:p:i:e:")) != -1)
+	{
+		switch(opt)
+		{
+			case 'v': sim.verbose = true; break;
+			case 'u': sim.uhid = true; break;
+			case 'l': loop_us = atof(optarg); break;
+			case 'p': poll_ms = atof(optarg); break;
+			case 'i': idle_ms = atof(optarg); break;
+			case 'e': eeprom = optarg; break;
+			default: usage(argv[0]); return 2;
+		}
+	}
+	if(optind != argc - 1)
+	{
+		usage(argv[0]);
+		return 2;
+	}
+	descriptor_length = sim_get_report_descriptors(descriptor, sizeof(descriptor));
+	if(descriptor_length == 0 || !hid_parse_descriptor(descriptor, descriptor_length, &sim.layout))
+	{
+		fprintf(stderr, "cannot parse the report descriptors\n");
+		return 2;
+	}
+	if(!load_script(argv[optind]))
+	{
+		return 2;
+	}
+	if(idle_ms >= 0)
+	{
+		// One interface at a time, the second once the first is through.
+		add_pin(0, PIN_IDLE, INTERFACE_KEYBOARD, (uint8_t)(idle_ms / 4));
+		add_pin(NS_PER_MS, PIN_IDLE, INTERFACE_CONSUMER, (uint8_t)(idle_ms / 4));
+	}
+	qsort(sim.pins, sim.pin_count, sizeof(PIN_EVENT), compare_pins);
+	qsort(sim.stimuli, sim.stimulus_count, sizeof(STIMULUS), compare_stimuli);
+	sim.remap_retry = SIM_NEVER;
+	if(sim.uhid)
+	{
+		static const uint8_t vendor[] = { USB_CFG_VENDOR_ID }, product[] = { USB_CFG_DEVICE_ID };
+		static const char name[] = { USB_CFG_DEVICE_NAME, 0 };
+
+		// One uhid device stands in for both interfaces.
+		if(!uhid_open(descriptor, descriptor_length,
+			vendor[0] | vendor[1] << 8, product[0] | product[1] << 8, name))
+		{
+			return 2;
+		}
+	}
+
+	memset(&config, 0, sizeof(config));
+	config.loop_ns = (uint32_t)(loop_us * 1000.0);
+	config.poll_interval_ns = (uint32_t)(poll_ms * NS_PER_MS);
+	sim.step_trail = (2 * ENCODER_ONESHOT_BACKLOG_MAX + 1) * (uint64_t)config.poll_interval_ns;
+	config.end_ns = sim.end;
+	config.next_stimulus = next_stimulus;
+	config.apply_stimulus = apply_stimulus;
+	config.report = on_report;
+	config.control = on_control;
+	sim_init(&config);
+	if(eeprom && !sim_eeprom_load(eeprom))
+	{
+		perror(eeprom);
+		return 2;
+	}
+
+	clock_t start = clock();
+	uint64_t simulated = sim_run();
+	double cpu_ms = (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+	const SIM_STATS *stats = sim_get_stats();
+
+	if(eeprom && !sim_eeprom_save(eeprom))
+	{
+		perror(eeprom);
+		return 2;
+	}
+
+	size_t dropped = 0, expected = 0, stuck = 0;
+	size_t cancelled = cancel_reversals();
+	for(size_t i = 0; i < sim.stimulus_count; i++)
+	{
+		if(sim.stimuli[i].kind == STIMULUS_RELEASE)
+		{
+			uint32_t usage = sim.held_usage[sim.stimuli[i].index];
+			if(!sim.stimuli[i].matched && usage != 0 && is_active(usage))
+			{
+				stuck++;
+				sim.held_usage[sim.stimuli[i].index] = 0;
+				if(sim.verbose)
+				{
+					printf("stuck: release at %.3f ms\n", sim.stimuli[i].t / 1e6);
+				}
+			}
+			continue;
+		}
+		expected++;
+		if(!sim.stimuli[i].matched && !sim.stimuli[i].cancelled)
+		{
+			dropped++;
+			if(sim.verbose)
+			{
+				printf("dropped: %s at %.3f ms\n",
+					sim.stimuli[i].kind == STIMULUS_DETENT ? "detent" : "press", sim.stimuli[i].t / 1e6);
+			}
+		}
+	}
+
+	printf("simulated %.3f s in %.1f ms CPU (%.0fx real time)\n",
+		simulated / 1e9, cpu_ms, cpu_ms > 0 ? simulated / 1e6 / cpu_ms : 0.0);
+	printf("loop passes %llu, timer2 interrupts %llu, host polls %llu, reports %llu\n",
+		(unsigned long long)stats->loop_passes, (unsigned long long)stats->timer2_interrupts,
+		(unsigned long long)stats->host_polls, (unsigned long long)stats->reports);
+	printf("inputs %zu, activations %llu, dropped %zu, stuck %zu, unexplained %llu\n",
+		expected, (unsigned long long)sim.activations, dropped, stuck, (unsigned long long)sim.extra);
+	if(cancelled)
+	{
+		printf("detents cancelled by turning back %zu\n", cancelled);
+	}
+	if(sim.accelerated)
+	{
+		printf("accelerated encoder steps %llu\n", (unsigned long long)sim.accelerated);
+	}
+	if(sim.wrong)
+	{
+		printf("presses with the wrong usage %u\n", sim.wrong);
+	}
+	printf("event queue overflows %u\n", eventQueue_get_overflow_count());
+	if(sim.remap_count)
+	{
+		printf("keymap remaps %zu, failed %u\n", sim.remap_count, sim.remap_failed);
+	}
+	if(stats->eeprom_writes || eepromWriter_get_pending())
+	{
+		printf("eeprom writes %llu, busy-wait %.3f ms, pending %u bytes\n",
+			(unsigned long long)stats->eeprom_writes, stats->eeprom_stall_ns / 1e6,
+			eepromWriter_get_pending());
+	}
+	REPORT_STATS reports;
+	reportScheduler_get_stats(&reports);
+	printf("reports sent %u, suppressed %u (unchanged poll slots)\n", reports.sent, reports.suppressed);
+	if(sim.peak_steps.requested)
+	{
+		printf("encoder steps/s     requested %u, delivered %u (peak seconds)\n",
+			sim.peak_steps.requested, sim.peak_steps.delivered);
+	}
+	print_latency("press", &sim.press_latency);
+	print_latency("release", &sim.release_latency);
+	print_latency("detent", &sim.detent_latency);
+	print_histograms();
+#ifdef PROFILER
+	print_profile();
+#endif
+	if(sim.uhid)
+	{
+		uhid_close();
+		printf("evdev: inputs without an event %llu\n", (unsigned long long)sim.evdev_silent);
+		print_latency("press", &sim.evdev_press_latency);
+		print_latency("release", &sim.evdev_release_latency);
+		print_latency("detent", &sim.evdev_detent_latency);
+	}
+
+	return dropped || stuck || sim.wrong || sim.remap_failed ? 1 : 0;
+}
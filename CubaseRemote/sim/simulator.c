@@ -0,0 +1,570 @@
+/*
+ * simulator.c
+ *
+ * Created: 17-Oct-26 9:31:05 AM
+ */ 
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avr/io.h>
+#include <avr/eeprom.h>
+
+#include "usbdrv.h"
+#include "simulator.h"
+
+#ifndef F_CPU
+#error "F_CPU must match the firmware build"
+#endif
+
+/* ------------------------------------------------------------------------- */
+/* Register file                                                             */
+/* ------------------------------------------------------------------------- */
+
+volatile uint8_t SREG;
+
+volatile uint8_t PINB, DDRB, PORTB;
+volatile uint8_t PINC, DDRC, PORTC;
+volatile uint8_t PIND, DDRD, PORTD;
+
+volatile uint8_t TCCR1A, TCCR1B;
+volatile uint8_t TCCR2, OCR2, TCNT2;
+volatile uint8_t TIMSK, TIFR;
+
+/* EEMEM variables, see avr/eeprom.h. The linker defines these for the
+ * section; they stay NULL if the firmware has no EEMEM data. */
+extern uint8_t __start_sim_eeprom[] __attribute__((weak));
+extern uint8_t __stop_sim_eeprom[] __attribute__((weak));
+
+#define EEPROM_WRITE_NS		8500000ULL		// erase + write, ATmega8A datasheet
+
+/* Firmware entry points (main.c is built with -Dmain=firmware_main). */
+int firmware_main(void);
+void TIMER2_COMP_vect(void);
+
+/* ------------------------------------------------------------------------- */
+
+static SIM_CONFIG _config;
+static SIM_STATS _stats;
+static jmp_buf _exit_jmp;
+
+static uint64_t _now;
+static uint64_t _next_timer2;
+static uint64_t _next_poll;
+
+static uint8_t _buttons;		// bit n set = button n held down
+static uint8_t _encoder = 0x03;	// both contacts open at a detent
+
+typedef struct
+{
+	uchar buffer[8];
+	uchar len;
+	bool pending;
+} SIM_ENDPOINT;
+
+static SIM_ENDPOINT _intr[2];	// endpoints 1 and 3
+
+enum CONTROL_STAGE
+{
+	CONTROL_IDLE,
+	CONTROL_SETUP,
+	CONTROL_OUT,
+	CONTROL_IN,
+};
+
+static usbRequest_t _setup;
+static uint8_t _control_stage;
+static uint8_t _control_data[256];
+static uint16_t _control_pos;
+
+static uint64_t _eeprom_ready;
+
+usbMsgPtr_t usbMsgPtr;
+
+static void sim_update_pins(void)
+{
+	/* Every input has its pull-up enabled, so an open contact reads 1. */
+	PINC = (uint8_t)(~_buttons & 0x3F);
+	PINB = (uint8_t)((PINB & ~(1 << PINB0)) | ((_buttons & (1 << 6)) ? 0 : (1 << PINB0)));
+	PIND = (uint8_t)((PIND & ~((1 << PIND6) | (1 << PIND7)))
+		| ((_encoder & 0x01) ? (1 << PIND6) : 0)
+		| ((_encoder & 0x02) ? (1 << PIND7) : 0));
+}
+
+/* Timer1 only ever runs free (profiler.c). Firmware code takes no
+ * simulated time apart from usbPoll() and delays, so it only measures those. */
+uint16_t sim_read_tcnt1(void)
+{
+	static const uint16_t prescaler[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+	uint16_t div = prescaler[TCCR1B & 0x07];
+
+	if(div == 0)
+	{
+		return 0;
+	}
+	return (uint16_t)(_now * (F_CPU / 1000000UL) / 1000 / div);
+}
+
+static uint64_t sim_timer2_period_ns(void)
+{
+	static const uint16_t prescaler[8] = { 0, 1, 8, 32, 64, 128, 256, 1024 };
+	uint16_t div = prescaler[TCCR2 & 0x07];
+	uint32_t top = (TCCR2 & (1 << WGM21)) ? (uint32_t)OCR2 + 1 : 256;
+
+	if(div == 0)
+	{
+		return 0;
+	}
+	return (uint64_t)top * div * 1000000000ULL / F_CPU;
+}
+
+static void sim_timer2_fire(void)
+{
+	_stats.timer2_interrupts++;
+	TIFR |= (1 << OCF2);
+}
+
+static void sim_dispatch_interrupts(void)
+{
+	if((SREG & (1 << SREG_I)) && (TIFR & (1 << OCF2)) && (TIMSK & (1 << OCIE2)))
+	{
+		TIFR &= ~(1 << OCF2);
+		SREG &= ~(1 << SREG_I);
+		TIMER2_COMP_vect();
+		SREG |= (1 << SREG_I);
+	}
+}
+
+static void sim_host_poll(void)
+{
+	_stats.host_polls++;
+	for(unsigned i = 0; i < sizeof(_intr) / sizeof(_intr[0]); i++)
+	{
+		if(_intr[i].pending)
+		{
+			_intr[i].pending = false;
+			_stats.reports++;
+			if(_config.report)
+			{
+				_config.report(_config.ctx, _now, _intr[i].buffer, _intr[i].len);
+			}
+		}
+	}
+}
+
+/* Process every timer, host and script event that is due, in time order. */
+static void sim_service(void)
+{
+	for(;;)
+	{
+		uint64_t period = sim_timer2_period_ns();
+		uint64_t stimulus = _config.next_stimulus ? _config.next_stimulus(_config.ctx) : SIM_NEVER;
+		uint64_t timer = SIM_NEVER;
+
+		if(period != 0)
+		{
+			if(_next_timer2 == SIM_NEVER)
+			{
+				_next_timer2 = _now + period;
+			}
+			timer = _next_timer2;
+		}
+		else
+		{
+			_next_timer2 = SIM_NEVER;
+		}
+
+		if(stimulus <= _now && stimulus <= timer && stimulus <= _next_poll)
+		{
+			_config.apply_stimulus(_config.ctx, stimulus);
+			sim_update_pins();
+		}
+		else if(timer <= _now && timer <= _next_poll)
+		{
+			_next_timer2 += period;
+			sim_timer2_fire();
+			sim_dispatch_interrupts();
+		}
+		else if(_next_poll <= _now)
+		{
+			_next_poll += _config.poll_interval_ns;
+			sim_host_poll();
+		}
+		else
+		{
+			break;
+		}
+	}
+	sim_dispatch_interrupts();
+
+	if(_now >= _config.end_ns)
+	{
+		longjmp(_exit_jmp, 1);
+	}
+}
+
+void sim_delay_us(double us)
+{
+	_now += (uint64_t)(us * 1000.0);
+	sim_service();
+}
+
+/* ------------------------------------------------------------------------- */
+/* V-USB stand-in                                                            */
+/* ------------------------------------------------------------------------- */
+
+USB_PUBLIC void usbInit(void)
+{
+	_intr[0].pending = _intr[1].pending = false;
+}
+
+static void sim_control_done(bool ok)
+{
+	_control_stage = CONTROL_IDLE;
+	if(_config.control)
+	{
+		_config.control(_config.ctx, _now, ok, _control_data, _control_pos);
+	}
+}
+
+static void sim_control_setup(void)
+{
+	usbMsgLen_t len = usbFunctionSetup((uchar *)&_setup);
+	uint16_t length = _setup.wLength.word;
+
+	_control_pos = 0;
+	if((_setup.bmRequestType & USBRQ_DIR_MASK) == USBRQ_DIR_DEVICE_TO_HOST)
+	{
+		if(len == USB_NO_MSG)
+		{
+			_control_stage = CONTROL_IN;
+			return;
+		}
+		_control_pos = len < length ? len : length;
+		memcpy(_control_data, (const void *)usbMsgPtr, _control_pos);
+		sim_control_done(true);
+	}
+	else if(len == USB_NO_MSG && length != 0)
+	{
+		_control_stage = CONTROL_OUT;
+	}
+	else
+	{
+		/* No data stage, or the firmware chose to ignore it. */
+		sim_control_done(true);
+	}
+}
+
+/* One data packet per usbPoll(), as V-USB handles one per call. */
+static void sim_control_packet(void)
+{
+	uint16_t left = _setup.wLength.word - _control_pos;
+	uchar chunk = left < 8 ? (uchar)left : 8;
+
+	if(_control_stage == CONTROL_OUT)
+	{
+		uchar result = usbFunctionWrite(&_control_data[_control_pos], chunk);
+		_control_pos += chunk;
+		if(result == 0xFF)
+		{
+			sim_control_done(false);
+		}
+		else if(result == 1 || _control_pos == _setup.wLength.word)
+		{
+			sim_control_done(true);
+		}
+	}
+	else
+	{
+		uchar n = usbFunctionRead(&_control_data[_control_pos], chunk);
+		_control_pos += n;
+		if(n < 8 || _control_pos == _setup.wLength.word)
+		{
+			sim_control_done(true);
+		}
+	}
+}
+
+USB_PUBLIC void usbPoll(void)
+{
+	_stats.loop_passes++;
+	_now += _config.loop_ns;
+	sim_service();
+	if(_control_stage == CONTROL_SETUP)
+	{
+		sim_control_setup();
+	}
+	else if(_control_stage != CONTROL_IDLE)
+	{
+		sim_control_packet();
+	}
+}
+
+static void sim_set_interrupt(SIM_ENDPOINT *ep, uchar *data, uchar len)
+{
+	if(len > sizeof(ep->buffer))
+	{
+		len = sizeof(ep->buffer);
+	}
+	memcpy(ep->buffer, data, len);
+	ep->len = len;
+	ep->pending = true;
+}
+
+USB_PUBLIC void usbSetInterrupt(uchar *data, uchar len)
+{
+	sim_set_interrupt(&_intr[0], data, len);
+}
+
+USB_PUBLIC uchar usbInterruptIsReady(void)
+{
+	return _intr[0].pending ? 0 : 0x10;
+}
+
+USB_PUBLIC void usbSetInterrupt3(uchar *data, uchar len)
+{
+	sim_set_interrupt(&_intr[1], data, len);
+}
+
+USB_PUBLIC uchar usbInterruptIsReady3(void)
+{
+	return _intr[1].pending ? 0 : 0x10;
+}
+
+/* The driver hands GET_DESCRIPTOR for HID and report descriptors to
+ * usbFunctionDescriptor() when usbconfig.h marks them dynamic. */
+uint16_t sim_get_report_descriptors(uint8_t *out, uint16_t size)
+{
+	const uint8_t *config = (const uint8_t *)usbDescriptorConfiguration;
+	uint16_t total = config[2] | config[3] << 8;
+	uint16_t length = 0;
+
+	for(uint16_t pos = 0; pos < total && config[pos] != 0; pos += config[pos])
+	{
+		usbRequest_t rq;
+		usbMsgLen_t len;
+
+		if(config[pos + 1] != USBDESCR_INTERFACE || config[pos + 5] != 3)
+		{
+			continue;
+		}
+		memset(&rq, 0, sizeof(rq));
+		rq.bmRequestType = USBRQ_DIR_DEVICE_TO_HOST | USBRQ_RCPT_INTERFACE;
+		rq.bRequest = USBRQ_GET_DESCRIPTOR;
+		rq.wValue.word = USBDESCR_HID_REPORT << 8;
+		rq.wIndex.word = config[pos + 2];
+		rq.wLength.word = 0xff;
+		len = usbFunctionDescriptor(&rq);
+		if(len == 0 || length + len > size)
+		{
+			return 0;
+		}
+		memcpy(&out[length], (const void *)usbMsgPtr, len);
+		length += len;
+	}
+	return length;
+}
+
+/* ------------------------------------------------------------------------- */
+/* EEPROM                                                                    */
+/* ------------------------------------------------------------------------- */
+
+static size_t sim_eeprom_size(void)
+{
+	return __start_sim_eeprom ? (size_t)(__stop_sim_eeprom - __start_sim_eeprom) : 0;
+}
+
+static uint8_t *sim_eeprom_cell(const void *addr)
+{
+	const uint8_t *p = addr;
+
+	if(sim_eeprom_size() == 0 || p < __start_sim_eeprom || p >= __stop_sim_eeprom)
+	{
+		fprintf(stderr, "EEPROM access outside EEMEM data\n");
+		abort();
+	}
+	return (uint8_t *)p;
+}
+
+/* The firmware spins on EEWE, with interrupts still running. */
+static void sim_eeprom_wait(void)
+{
+	if(_now < _eeprom_ready)
+	{
+		_stats.eeprom_stall_ns += _eeprom_ready - _now;
+		sim_delay_us((_eeprom_ready - _now) / 1000.0);
+	}
+}
+
+int eeprom_is_ready(void)
+{
+	return _now >= _eeprom_ready;
+}
+
+uint8_t eeprom_read_byte(const uint8_t *addr)
+{
+	sim_eeprom_wait();
+	return *sim_eeprom_cell(addr);
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+	sim_eeprom_wait();
+	for(size_t i = 0; i < n; i++)
+	{
+		((uint8_t *)dst)[i] = *sim_eeprom_cell((const uint8_t *)src + i);
+	}
+}
+
+void eeprom_write_byte(uint8_t *addr, uint8_t value)
+{
+	sim_eeprom_wait();
+	*sim_eeprom_cell(addr) = value;
+	_eeprom_ready = _now + EEPROM_WRITE_NS;
+	_stats.eeprom_writes++;
+}
+
+void eeprom_update_byte(uint8_t *addr, uint8_t value)
+{
+	if(eeprom_read_byte(addr) != value)
+	{
+		eeprom_write_byte(addr, value);
+	}
+}
+
+bool sim_eeprom_load(const char *path)
+{
+	FILE *f = fopen(path, "rb");
+
+	if(f == NULL)
+	{
+		return errno == ENOENT;
+	}
+	if(sim_eeprom_size() != 0)
+	{
+		fread(__start_sim_eeprom, 1, sim_eeprom_size(), f);
+	}
+	fclose(f);
+	return true;
+}
+
+bool sim_eeprom_save(const char *path)
+{
+	FILE *f = fopen(path, "wb");
+	bool ok;
+
+	if(f == NULL)
+	{
+		return false;
+	}
+	ok = fwrite(__start_sim_eeprom, 1, sim_eeprom_size(), f) == sim_eeprom_size();
+	return fclose(f) == 0 && ok;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void sim_init(const SIM_CONFIG *config)
+{
+	_config = *config;
+	memset(&_stats, 0, sizeof(_stats));
+	_now = 0;
+	_next_timer2 = SIM_NEVER;
+	_next_poll = _config.poll_interval_ns;
+	_buttons = 0;
+	_encoder = 0x03;
+	_intr[0].pending = _intr[1].pending = false;
+	_control_stage = CONTROL_IDLE;
+	_eeprom_ready = 0;
+	if(sim_eeprom_size() != 0)
+	{
+		memset(__start_sim_eeprom, 0xFF, sim_eeprom_size());
+	}
+
+	SREG = 0;
+	DDRB = DDRC = DDRD = 0;
+	PORTB = PORTC = PORTD = 0;
+	TCCR1A = TCCR1B = 0;
+	TCCR2 = OCR2 = TCNT2 = 0;
+	TIMSK = TIFR = 0;
+	sim_update_pins();
+}
+
+uint64_t sim_run(void)
+{
+	if(setjmp(_exit_jmp) == 0)
+	{
+		firmware_main();
+	}
+	return _now;
+}
+
+void sim_stop(void)
+{
+	_config.end_ns = _now;
+}
+
+uint64_t sim_now_ns(void)
+{
+	return _now;
+}
+
+const SIM_STATS *sim_get_stats(void)
+{
+	return &_stats;
+}
+
+void sim_set_button(uint8_t button, bool pressed)
+{
+	if(button >= SIM_BUTTON_COUNT)
+	{
+		return;
+	}
+	if(pressed)
+	{
+		_buttons |= (uint8_t)(1 << button);
+	}
+	else
+	{
+		_buttons &= (uint8_t)~(1 << button);
+	}
+}
+
+void sim_set_encoder(uint8_t pins)
+{
+	_encoder = pins & 0x03;
+}
+
+void sim_control_request(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex)
+{
+	memset(&_setup, 0, sizeof(_setup));
+	_setup.bmRequestType = bmRequestType;
+	_setup.bRequest = bRequest;
+	_setup.wValue.word = wValue;
+	_setup.wIndex.word = wIndex;
+	_control_stage = CONTROL_SETUP;
+}
+
+void sim_control_write(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex,
+	const uint8_t *data, uint16_t len)
+{
+	if(len > sizeof(_control_data))
+	{
+		len = sizeof(_control_data);
+	}
+	sim_control_request(bmRequestType, bRequest, wValue, wIndex);
+	_setup.wLength.word = len;
+	memcpy(_control_data, data, len);
+}
+
+void sim_control_read(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, uint16_t len)
+{
+	if(len > sizeof(_control_data))
+	{
+		len = sizeof(_control_data);
+	}
+	sim_control_request(bmRequestType, bRequest, wValue, wIndex);
+	_setup.wLength.word = len;
+}
@@ -0,0 +1,93 @@
+/*
+ * simulator.h
+ *
+ * Host-side model of the ATmega8A around the firmware: a virtual clock,
+ * the register file from avr/io.h, timer2, the EEPROM and a USB host that
+ * polls the interrupt-IN endpoints and runs control transfers. The real
+ * firmware main() runs on top of it.
+ *
+ * Created: 17-Oct-26 9:24:37 AM
+ */ 
+
+
+#ifndef SIMULATOR_H_
+#define SIMULATOR_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SIM_NEVER	UINT64_MAX
+
+#define SIM_BUTTON_COUNT	7	// BTN1..BTN6 on PINC0..5, encoder switch on PINB0
+
+typedef struct
+{
+	uint32_t loop_ns;			// simulated cost of one main loop pass
+	uint32_t poll_interval_ns;	// host interrupt-IN polling period
+	uint64_t end_ns;			// stop the firmware at this time
+
+	// Returns the time of the next scripted pin change, SIM_NEVER if none.
+	uint64_t (*next_stimulus)(void *ctx);
+	// Applies every scripted pin change due at 'now_ns'.
+	void (*apply_stimulus)(void *ctx, uint64_t now_ns);
+	// Called when the host picks up an interrupt-IN report, from endpoint
+	// 1 first when both have one.
+	void (*report)(void *ctx, uint64_t now_ns, const uint8_t *data, uint8_t len);
+	// Called when a control transfer completes; 'data' holds the IN data
+	// stage, if any. 'ok' is false if the firmware stalled the request.
+	void (*control)(void *ctx, uint64_t now_ns, bool ok, const uint8_t *data, uint16_t len);
+	void *ctx;
+} SIM_CONFIG;
+
+typedef struct
+{
+	uint64_t loop_passes;
+	uint64_t timer2_interrupts;
+	uint64_t host_polls;
+	uint64_t reports;
+	uint64_t eeprom_writes;
+	uint64_t eeprom_stall_ns;	// time the firmware busy-waited on the EEPROM
+} SIM_STATS;
+
+void sim_init(const SIM_CONFIG *config);
+
+// Runs the firmware until config->end_ns. Returns the simulated time reached.
+uint64_t sim_run(void);
+
+// Ends sim_run() at the current time. Call from a SIM_CONFIG callback.
+void sim_stop(void);
+
+uint64_t sim_now_ns(void);
+
+const SIM_STATS *sim_get_stats(void);
+
+// Buttons are active low with pull-ups; 'pressed' pulls the pin to ground.
+void sim_set_button(uint8_t button, bool pressed);
+
+// Encoder contacts A (PIND6) and B (PIND7), one bit each.
+void sim_set_encoder(uint8_t pins);
+
+// Queues a control request without data stage; the firmware's
+// usbFunctionSetup() sees it on the next usbPoll(), as with V-USB.
+void sim_control_request(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex);
+
+// Control transfers with a data stage. Each usbPoll() after the setup
+// moves one 8-byte packet, through usbFunctionWrite() / usbFunctionRead()
+// when usbFunctionSetup() returned USB_NO_MSG. A new request replaces one
+// still in progress.
+void sim_control_write(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex,
+	const uint8_t *data, uint16_t len);
+void sim_control_read(uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, uint16_t len);
+
+// Fetches the report descriptor of every HID interface in the firmware's
+// configuration descriptor, as a host enumerating it would, and stores them
+// back to back. Report IDs are unique across the interfaces, so the result
+// parses as one descriptor. Returns its length, 0 if it does not fit.
+uint16_t sim_get_report_descriptors(uint8_t *out, uint16_t size);
+
+// EEPROM image file, loaded before sim_run() and saved after it.
+// A missing file leaves the EEPROM erased. Return false on I/O errors.
+bool sim_eeprom_load(const char *path);
+bool sim_eeprom_save(const char *path);
+
+#endif /* SIMULATOR_H_ */
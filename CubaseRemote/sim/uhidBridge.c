@@ -0,0 +1,236 @@
+/*
+ * uhidBridge.c
+ *
+ * UHID_INPUT2 is handled synchronously: by the time write() returns the
+ * kernel has parsed the report and queued the resulting events on every
+ * evdev client. Draining the device's evdev nodes right after each write
+ * therefore ties every event to the report that caused it, without having
+ * to know how the kernel maps HID usages to key codes. The nodes are
+ * switched to CLOCK_MONOTONIC so their timestamps compare with ours.
+ *
+ * Created: 17-Oct-26 8:14:05 PM
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/input.h>
+#include <linux/uhid.h>
+#include <sys/ioctl.h>
+
+#include "uhidBridge.h"
+
+#define NS_PER_S			1000000000ULL
+#define EVDEV_MAX			4			// one per HID application the kernel splits off
+#define EVDEV_WAIT_MS		3000		// for udev to create the nodes
+
+static int _uhid = -1;
+static int _evdev[EVDEV_MAX];
+static unsigned _evdevCount;
+static uint64_t _start;
+static char _uniq[64];
+
+static uint64_t monotonic_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * NS_PER_S + (uint64_t)ts.tv_nsec;
+}
+
+static bool uhid_write(const struct uhid_event *ev)
+{
+	ssize_t n = write(_uhid, ev, sizeof(*ev));
+	if(n != (ssize_t)sizeof(*ev))
+	{
+		perror("/dev/uhid");
+		return false;
+	}
+	return true;
+}
+
+/* The kernel may ask for feature reports while the driver binds; answer
+ * them with an error rather than let it wait for the timeout. */
+static void uhid_service(void)
+{
+	struct uhid_event ev;
+
+	while(read(_uhid, &ev, sizeof(ev)) > 0)
+	{
+		struct uhid_event reply;
+
+		memset(&reply, 0, sizeof(reply));
+		if(ev.type == UHID_GET_REPORT)
+		{
+			reply.type = UHID_GET_REPORT_REPLY;
+			reply.u.get_report_reply.id = ev.u.get_report.id;
+			reply.u.get_report_reply.err = EIO;
+			uhid_write(&reply);
+		}
+		else if(ev.type == UHID_SET_REPORT)
+		{
+			reply.type = UHID_SET_REPORT_REPLY;
+			reply.u.set_report_reply.id = ev.u.set_report.id;
+			reply.u.set_report_reply.err = EIO;
+			uhid_write(&reply);
+		}
+	}
+}
+
+static void evdev_scan(void)
+{
+	DIR *dir = opendir("/dev/input");
+	struct dirent *entry;
+
+	if(dir == NULL)
+	{
+		return;
+	}
+	while((entry = readdir(dir)) != NULL && _evdevCount < EVDEV_MAX)
+	{
+		char path[300], uniq[64] = "";
+		int fd;
+
+		if(strncmp(entry->d_name, "event", 5) != 0)
+		{
+			continue;
+		}
+		snprintf(path, sizeof(path), "/dev/input/%s", entry->d_name);
+		fd = open(path, O_RDONLY | O_NONBLOCK);
+		if(fd < 0)
+		{
+			continue;
+		}
+		if(ioctl(fd, EVIOCGUNIQ(sizeof(uniq) - 1), uniq) < 0 || strcmp(uniq, _uniq) != 0)
+		{
+			close(fd);
+			continue;
+		}
+		int clock = CLOCK_MONOTONIC;
+		ioctl(fd, EVIOCSCLOCKID, &clock);
+		_evdev[_evdevCount++] = fd;
+	}
+	closedir(dir);
+}
+
+bool uhid_open(const uint8_t *descriptor, uint16_t length, uint16_t vendor, uint16_t product, const char *name)
+{
+	struct uhid_event ev;
+
+	_uhid = open("/dev/uhid", O_RDWR | O_CLOEXEC | O_NONBLOCK);
+	if(_uhid < 0)
+	{
+		perror("/dev/uhid");
+		return false;
+	}
+	if(length > sizeof(ev.u.create2.rd_data))
+	{
+		fprintf(stderr, "report descriptor too long for uhid\n");
+		return false;
+	}
+
+	// The uniq string finds our evdev nodes among the real ones.
+	snprintf(_uniq, sizeof(_uniq), "cubaseremote-sim-%d", (int)getpid());
+	memset(&ev, 0, sizeof(ev));
+	ev.type = UHID_CREATE2;
+	snprintf((char *)ev.u.create2.name, sizeof(ev.u.create2.name), "%s", name);
+	snprintf((char *)ev.u.create2.uniq, sizeof(ev.u.create2.uniq), "%s", _uniq);
+	ev.u.create2.rd_size = length;
+	ev.u.create2.bus = BUS_USB;
+	ev.u.create2.vendor = vendor;
+	ev.u.create2.product = product;
+	memcpy(ev.u.create2.rd_data, descriptor, length);
+	if(!uhid_write(&ev))
+	{
+		return false;
+	}
+
+	for(unsigned waited = 0; waited < EVDEV_WAIT_MS; waited += 50)
+	{
+		uhid_service();
+		evdev_scan();
+		if(_evdevCount != 0)
+		{
+			break;
+		}
+		usleep(50000);
+	}
+	if(_evdevCount == 0)
+	{
+		fprintf(stderr, "no evdev node appeared for %s\n", _uniq);
+		uhid_close();
+		return false;
+	}
+	// Nodes for further applications are created along with the first.
+	usleep(200000);
+	evdev_scan();
+	_start = monotonic_ns();
+	return true;
+}
+
+void uhid_close(void)
+{
+	struct uhid_event ev;
+
+	for(unsigned i = 0; i < _evdevCount; i++)
+	{
+		close(_evdev[i]);
+	}
+	_evdevCount = 0;
+	if(_uhid >= 0)
+	{
+		memset(&ev, 0, sizeof(ev));
+		ev.type = UHID_DESTROY;
+		uhid_write(&ev);
+		close(_uhid);
+		_uhid = -1;
+	}
+}
+
+uint64_t uhid_wall_time(uint64_t sim_ns)
+{
+	return _start + sim_ns;
+}
+
+uint64_t uhid_wait(uint64_t sim_ns)
+{
+	uint64_t t = uhid_wall_time(sim_ns);
+	struct timespec ts = { (time_t)(t / NS_PER_S), (long)(t % NS_PER_S) };
+
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+	{
+	}
+	return t;
+}
+
+uint64_t uhid_send(const uint8_t *data, uint8_t len)
+{
+	struct uhid_event ev;
+	struct input_event in;
+	uint64_t first = 0;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.type = UHID_INPUT2;
+	ev.u.input2.size = len;
+	memcpy(ev.u.input2.data, data, len);
+	uhid_service();
+	if(!uhid_write(&ev))
+	{
+		return 0;
+	}
+	for(unsigned i = 0; i < _evdevCount; i++)
+	{
+		while(read(_evdev[i], &in, sizeof(in)) == (ssize_t)sizeof(in))
+		{
+			uint64_t t = (uint64_t)in.input_event_sec * NS_PER_S + (uint64_t)in.input_event_usec * 1000ULL;
+			if(in.type != EV_SYN && (first == 0 || t < first))
+			{
+				first = t;
+			}
+		}
+	}
+	return first;
+}
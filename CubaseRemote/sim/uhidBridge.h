@@ -0,0 +1,38 @@
+/*
+ * uhidBridge.h
+ *
+ * Mirrors the simulated device into the Linux input stack through
+ * /dev/uhid, so reports go through the kernel HID driver and evdev like
+ * those of the real keyboard, and reads back when evdev saw them.
+ *
+ * Created: 17-Oct-26 8:12:40 PM
+ */
+
+
+#ifndef UHIDBRIDGE_H_
+#define UHIDBRIDGE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Creates the virtual device from the report descriptor and opens the
+// evdev nodes the kernel makes for it. Prints why and returns false if
+// /dev/uhid cannot be used.
+bool uhid_open(const uint8_t *descriptor, uint16_t length, uint16_t vendor, uint16_t product, const char *name);
+
+void uhid_close(void);
+
+// Sleeps until 'sim_ns' of simulated time has passed on the wall clock
+// since uhid_open(). Returns that point as CLOCK_MONOTONIC ns.
+uint64_t uhid_wait(uint64_t sim_ns);
+
+// CLOCK_MONOTONIC ns of simulated time 'sim_ns', see uhid_wait().
+uint64_t uhid_wall_time(uint64_t sim_ns);
+
+// Hands an input report (report ID first) to the kernel. Returns the
+// evdev timestamp of the first event it caused, CLOCK_MONOTONIC ns, or 0
+// if the kernel turned it into no input event.
+uint64_t uhid_send(const uint8_t *data, uint8_t len);
+
+
+#endif /* UHIDBRIDGE_H_ */
@@ -0,0 +1,104 @@
+/*
+ * usbdrv.h
+ *
+ * Host stand-in for the V-USB driver API. It exposes the same names the
+ * firmware uses; simulator.c implements them on top of a model of a host
+ * that polls both interrupt-IN endpoints every USB_CFG_INTR_POLL_INTERVAL ms.
+ *
+ * Created: 17-Oct-26 9:18:45 AM
+ */ 
+
+
+#ifndef __usbdrv_h_included__
+#define __usbdrv_h_included__
+
+#include <stdint.h>
+#include "usbconfig.h"
+
+typedef unsigned char	uchar;
+typedef signed char		schar;
+
+/* usbconfig.h squeezes usbMsgPtr into 16 bits for the AVR; the host needs
+ * a full pointer. */
+#undef usbMsgPtr_t
+#define usbMsgPtr_t uintptr_t
+
+#define usbMsgLen_t uchar
+#define USB_NO_MSG  ((usbMsgLen_t)-1)
+
+#define USB_PUBLIC
+
+typedef union usbWord{
+	uint16_t	word;
+	uchar		bytes[2];
+}usbWord_t;
+
+typedef struct usbRequest{
+	uchar		bmRequestType;
+	uchar		bRequest;
+	usbWord_t	wValue;
+	usbWord_t	wIndex;
+	usbWord_t	wLength;
+}usbRequest_t;
+
+extern usbMsgPtr_t usbMsgPtr;
+
+USB_PUBLIC void usbInit(void);
+USB_PUBLIC void usbPoll(void);
+USB_PUBLIC usbMsgLen_t usbFunctionSetup(uchar data[8]);
+USB_PUBLIC uchar usbFunctionRead(uchar *data, uchar len);
+USB_PUBLIC uchar usbFunctionWrite(uchar *data, uchar len);
+USB_PUBLIC usbMsgLen_t usbFunctionDescriptor(struct usbRequest *rq);
+USB_PUBLIC void usbSetInterrupt(uchar *data, uchar len);
+USB_PUBLIC uchar usbInterruptIsReady(void);
+USB_PUBLIC void usbSetInterrupt3(uchar *data, uchar len);
+USB_PUBLIC uchar usbInterruptIsReady3(void);
+
+/* Descriptor properties, as in usbconfig.h */
+#define USB_PROP_IS_DYNAMIC     (1u << 14)
+#define USB_PROP_IS_RAM         (1u << 15)
+#define USB_PROP_LENGTH(len)    ((len) & 0x3fff)
+
+extern const char usbDescriptorConfiguration[];
+
+#define usbDeviceConnect()
+#define usbDeviceDisconnect()
+
+/* USB setup recipient values */
+#define USBRQ_RCPT_MASK         0x1f
+#define USBRQ_RCPT_DEVICE       0
+#define USBRQ_RCPT_INTERFACE    1
+#define USBRQ_RCPT_ENDPOINT     2
+
+/* USB request type values */
+#define USBRQ_TYPE_MASK         0x60
+#define USBRQ_TYPE_STANDARD     (0<<5)
+#define USBRQ_TYPE_CLASS        (1<<5)
+#define USBRQ_TYPE_VENDOR       (2<<5)
+
+/* USB direction values: */
+#define USBRQ_DIR_MASK              0x80
+#define USBRQ_DIR_HOST_TO_DEVICE    (0<<7)
+#define USBRQ_DIR_DEVICE_TO_HOST    (1<<7)
+
+/* Descriptor types */
+#define USBDESCR_DEVICE         1
+#define USBDESCR_CONFIG         2
+#define USBDESCR_STRING         3
+#define USBDESCR_INTERFACE      4
+#define USBDESCR_ENDPOINT       5
+#define USBDESCR_HID            0x21
+#define USBDESCR_HID_REPORT     0x22
+
+/* Standard requests */
+#define USBRQ_GET_DESCRIPTOR    6
+
+/* HID class requests */
+#define USBRQ_HID_GET_REPORT    0x01
+#define USBRQ_HID_GET_IDLE      0x02
+#define USBRQ_HID_GET_PROTOCOL  0x03
+#define USBRQ_HID_SET_REPORT    0x09
+#define USBRQ_HID_SET_IDLE      0x0a
+#define USBRQ_HID_SET_PROTOCOL  0x0b
+
+#endif /* __usbdrv_h_included__ */
@@ -0,0 +1,39 @@
+/*
+ * util/atomic.h
+ *
+ * Host stand-in for avr-libc's ATOMIC_BLOCK. The simulator only delivers
+ * interrupts between main loop passes, so saving and restoring SREG_I is
+ * all that is needed to keep the same semantics.
+ *
+ * Created: 17-Oct-26 11:32:09 AM
+ */ 
+
+
+#ifndef SIM_UTIL_ATOMIC_H_
+#define SIM_UTIL_ATOMIC_H_
+
+#include <avr/interrupt.h>
+
+static __inline__ uint8_t __iCliRetVal(void)
+{
+	cli();
+	return 1;
+}
+
+static __inline__ void __iRestore(const uint8_t *__s)
+{
+	SREG = *__s;
+}
+
+static __inline__ void __iSeiParam(const uint8_t *__s)
+{
+	(void)__s;
+	sei();
+}
+
+#define ATOMIC_BLOCK(type)	for(type, __ToDo = __iCliRetVal(); __ToDo ; __ToDo = 0)
+
+#define ATOMIC_RESTORESTATE	uint8_t sreg_save __attribute__((__cleanup__(__iRestore))) = SREG
+#define ATOMIC_FORCEON		uint8_t sreg_save __attribute__((__cleanup__(__iSeiParam))) = 0
+
+#endif /* SIM_UTIL_ATOMIC_H_ */
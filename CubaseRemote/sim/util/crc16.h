@@ -0,0 +1,34 @@
+/*
+ * util/crc16.h
+ *
+ * Host stand-in for avr-libc's CRC helpers, the C equivalents given in
+ * the avr-libc documentation.
+ *
+ * Created: 17-Oct-26 5:34:50 PM
+ */ 
+
+
+#ifndef SIM_UTIL_CRC16_H_
+#define SIM_UTIL_CRC16_H_
+
+#include <stdint.h>
+
+/* Polynomial x^16 + x^15 + x^2 + 1 (0xA001), as used by Modbus. */
+static inline uint16_t _crc16_update(uint16_t crc, uint8_t a)
+{
+	crc ^= a;
+	for(uint8_t i = 0; i < 8; ++i)
+	{
+		if(crc & 1)
+		{
+			crc = (crc >> 1) ^ 0xA001;
+		}
+		else
+		{
+			crc = (crc >> 1);
+		}
+	}
+	return crc;
+}
+
+#endif /* SIM_UTIL_CRC16_H_ */
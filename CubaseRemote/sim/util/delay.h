@@ -0,0 +1,19 @@
+/*
+ * util/delay.h
+ *
+ * Host stand-in for avr-libc's busy-wait delays. Delays advance the
+ * simulated clock instead of spinning.
+ *
+ * Created: 17-Oct-26 9:16:10 AM
+ */ 
+
+
+#ifndef SIM_UTIL_DELAY_H_
+#define SIM_UTIL_DELAY_H_
+
+void sim_delay_us(double us);
+
+#define _delay_us(us)	sim_delay_us(us)
+#define _delay_ms(ms)	sim_delay_us((ms) * 1000.0)
+
+#endif /* SIM_UTIL_DELAY_H_ */